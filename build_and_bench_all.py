@@ -4,6 +4,7 @@
 # collate the results and sort them according to Mean Ratio to Best
 # update the README with the table of results
 
+import contextlib
 import datetime
 import json
 import os
@@ -12,10 +13,12 @@ import yaml
 import sys
 import ast
 import platform
+import re
 import shutil
+import time
 
 runtimes = {
-    "cpp": ["citor", "libfork", "TooManyCooks", "tbb", "taskflow", "cppcoro", "coros", "cobalt",
+    "cpp": ["citor", "libfork", "TooManyCooks", "tbb", "taskflow", "openmp", "refsched", "cppcoro", "coros", "cobalt",
             # these 4 are quite slow - you can remove them to speed up total runtime
             "folly", "concurrencpp", "HPX", "libcoro"]
 }
@@ -28,6 +31,8 @@ runtime_links = {
     "TooManyCooks": "https://github.com/tzcnt/TooManyCooks",
     "tbb": "https://www.intel.com/content/www/us/en/developer/tools/oneapi/onetbb.html",
     "taskflow": "https://github.com/taskflow/taskflow",
+    "openmp": "https://www.openmp.org/specifications/",
+    "refsched": "cpp/2common/refsched.hpp",
     "cppcoro": "https://github.com/andreasbuhr/cppcoro",
     "coros": "https://github.com/mtmucha/coros",
     "cobalt": "https://github.com/boostorg/cobalt",
@@ -37,7 +42,7 @@ runtime_links = {
     "libcoro": "https://github.com/jbaldwin/libcoro"
 }
 
-benchmarks_order = ["skynet", "nqueens", "fib", "matmul", "channel", "io_socket_st"]
+benchmarks_order = ["skynet", "nqueens", "fib", "matmul", "channel", "io_socket_st", "sync", "flat_spawn", "pipeline", "generator", "timer", "nqueens_first", "exception_storm", "when_any", "priority", "blocking", "hop"]
 
 benchmarks={
     "skynet": {
@@ -49,14 +54,55 @@ benchmarks={
     "nqueens": {
 
     },
+    # params is the matrix size. 2000 avoids the cache-set aliasing of power-of-two sizes
     "matmul": {
-        "params": ["2048"]
+        "params": ["2000", "2048"]
     },
     "channel": {
 
     },
     "io_socket_st": {
 
+    },
+    # params is the number of tasks contending for the primitive
+    "sync": {
+        "params": ["1", "16", "256"]
+    },
+    "flat_spawn": {
+
+    },
+    "pipeline": {
+
+    },
+    # params is the number of nested transform/filter generators
+    "generator": {
+        "params": ["1", "4", "8"]
+    },
+    # params is the number of tasks with a timer armed at the same time
+    "timer": {
+        "params": ["1000", "10000", "100000"]
+    },
+    "nqueens_first": {
+
+    },
+    # params is the number of leaves per million that throw
+    "exception_storm": {
+        "params": ["0", "1", "100", "10000"]
+    },
+    # params is the number of tasks in each race
+    "when_any": {
+        "params": ["2", "8", "32"]
+    },
+    "priority": {
+
+    },
+    # params is the percentage of tasks that make a blocking call
+    "blocking": {
+        "params": ["0", "1", "10"]
+    },
+    # params is the number of executor hops per request
+    "hop": {
+        "params": ["2", "8", "32"]
     }
 }
 
@@ -69,13 +115,133 @@ benchmark_configs = {
         "channel": ["st_asio"]
     },
     "libcoro": {
-        "channel": ["mt"]
+        "channel": ["mt"],
+        "sync": ["mutex", "latch", "event"]
     },
+    "libfork": {
+        "fib": ["", "2pool"],
+        "skynet": ["", "2pool"]
+    },
+    "TooManyCooks": {
+        "fib": ["", "2pool"],
+        "skynet": ["", "2pool"],
+        "matmul": ["", "firsttouch"],
+        "channel": ["st_asio", "mt"],
+        "sync": ["mutex", "semaphore", "barrier", "latch", "event"],
+        "priority": ["high", "same", "high-4", "high-16"],
+        "blocking": ["inplace", "offload"]
+    },
+    "tbb": {
+        "fib": ["", "2pool"],
+        "skynet": ["", "2pool"],
+        "matmul": ["", "firsttouch"],
+        "sync": ["mutex"],
+        "priority": ["high", "same"],
+        "blocking": ["inplace", "offload"]
+    },
+    # each config changes one design choice of the reference scheduler from its default
+    "refsched": {
+        "fib": ["", "locked", "roundrobin", "sticky", "spin", "yield", "coro"],
+        "skynet": ["", "locked", "roundrobin", "sticky", "spin", "yield", "coro"],
+        "nqueens": ["", "locked", "roundrobin", "sticky", "spin", "yield", "coro"],
+        "matmul": ["", "locked", "roundrobin", "sticky", "spin", "yield", "coro"]
+    },
+    "cppcoro": {
+        "sync": ["mutex", "latch", "event"]
+    },
+    "folly": {
+        "sync": ["mutex", "event"],
+        "blocking": ["inplace", "offload"]
+    },
+    "concurrencpp": {
+        "sync": ["mutex"]
+    },
+}
+
+# Configs that every runtime supports for a benchmark, in addition to its entries in
+# benchmark_configs. For matmul, the config selects the base case kernel and the element
+# type, joined by "-".
+common_benchmark_configs = {
+    "matmul": ["", "blocked", "simd", "float", "float-simd"]
+}
+
+# Configs that run a different executable of the benchmark, built by the runtime with
+# other compile-time options. The config is still passed to the executable.
+# Format: { "runtime": { "benchmark": { "config": "executable", ... }, ... }, ... }
+config_executables = {
     "TooManyCooks": {
-        "channel": ["st_asio", "mt"]
+        # built with TMC_PRIORITY_COUNT=<N> instead of 2
+        "priority": {"high-4": "priority_4", "high-16": "priority_16"}
     },
 }
 
+# With --oversub, the fork-join benchmarks are also run with each of these multiples of
+# the largest thread count. The runtime name is suffixed with "_oversub<factor>x".
+fork_join_benchmarks = ["skynet", "nqueens", "fib", "matmul"]
+oversubscription_factors = [2, 4]
+
+# The serial elision of the fork-join benchmarks, with every task replaced by a plain
+# function call, is always built and run once on a single thread as a reference. It
+# isn't ranked against the runtimes; instead each runtime's fork-join runs record
+#   overhead   - T(runtime, 1 thread) / T(serial), on the 1 thread run
+#   efficiency - T(serial) / (threads * T(runtime, threads)), on every run
+# comparing runs of the serial reference with the same params and config. Configs
+# the serial reference doesn't have (e.g. a runtime's scheduler options) compare
+# against its default config. All of its runs are stored under serial_runtime.
+serial_runtime = "serial"
+
+# With --cutoff, the fork-join benchmarks are also run at the largest thread count with
+# each of these grain sizes, passed in the CUTOFF environment variable (see
+# cpp/2common/cutoff.hpp for what each one counts). Each sweep includes the default,
+# in ascending order. The runtime name is suffixed with "_cutoff"; these runs aren't
+# ranked, and CUTOFF_<benchmark>.svg plots the duration against the grain size for
+# each runtime.
+cutoff_sweep = {
+    "skynet": [0, 1, 2, 3],
+    "nqueens": [0, 2, 4, 6],
+    "fib": [2, 8, 14, 20],
+    "matmul": [16, 32, 64, 128, 256],
+}
+
+# Flags that may be combined with any of the modes below, as --name or --name=value
+known_options = {
+    "oversub": "also run the fork-join benchmarks with 2x and 4x more threads than the largest thread count",
+    "noise": "also run each benchmark alongside background load, reporting the slowdown (--noise=K[:busy|membw] for K processes)",
+    "placement": "run each benchmark under each CPU placement policy (--placement=core,l3,... for a subset)",
+    "cutoff": "also run the fork-join benchmarks with a range of grain sizes and plot the duration against it",
+    "profile": "record benchmarks with perf and write flamegraphs (--profile=runtime[:benchmark[:threads]],... for a subset)",
+}
+
+# CPU placement policies for --placement. The benchmark is restricted to a set of
+# thread_count CPUs chosen by the policy, using taskset. The runtime name is suffixed
+# with "_<policy>" unless the policy is "none".
+#   none   - no restriction; the runtime's own pinning (if any) applies
+#   core   - one CPU on each of the first thread_count physical cores
+#   l3     - like core, but fills one last-level cache domain (L3/CCX) before the next
+#   spread - like core, but takes cores round-robin from each last-level cache domain
+#   numa   - all CPUs, including SMT siblings, filling one NUMA node before the next
+placement_policies = ["none", "core", "l3", "spread", "numa"]
+
+# With --profile, benchmarks are rebuilt with debug info into profile_build_dir and run
+# once more under perf record. Each selection is runtime[:benchmark[:threads]]; by
+# default every fork-join benchmark of each runtime is profiled at the largest thread
+# count. The folded stacks and a flamegraph of each run are written to profile_dir as
+# <runtime>_<benchmark>_<threads>.folded / .svg, and linked from RESULTS.html.
+profile_preset = "clang-linux-relwithdebinfo"
+profile_build_dir = "build_profile"
+profile_dir = "profiles"
+# The release flags omit frame pointers, so stacks are unwound from the debug info
+profile_perf_args = "-F 999 --call-graph dwarf"
+
+# Background loads for --noise. Each runs in its own process pinned to one of the
+# highest-numbered CPUs, where the runtimes' worker threads will collide with it.
+noise_programs = {
+    # spins on one CPU
+    "busy": "while True: pass",
+    # repeatedly copies a buffer much larger than the LLC to consume memory bandwidth
+    "membw": "b = bytearray(256 << 20)\nwhile True: bytes(b)",
+}
+
 def print_usage():
     runtime_list = ", ".join(runtime for runtime_names in runtimes.values() for runtime in runtime_names)
     print("Usage:")
@@ -85,10 +251,98 @@ def print_usage():
     print("Benchmark a specific runtime (git-ref can be a SHA, tag, or branch):")
     print("  ./build_and_bench_all.py <runtime> [git-ref]")
     print("  ./build_and_bench_all.py compare <runtime> <new-git-ref> [baseline-git-ref]")
+    print("Options:")
+    for name, description in known_options.items():
+        print(f"  --{name}: {description}")
     print(f"\nRuntimes: {runtime_list}")
 
+def parse_options(args):
+    options = {}
+    rest = []
+    for arg in args:
+        if not arg.startswith("--"):
+            rest.append(arg)
+            continue
+        name, _, value = arg[2:].partition("=")
+        if name not in known_options:
+            print(f"Unknown option: {arg}\n")
+            print_usage()
+            sys.exit(1)
+        options[name] = value
+    return options, rest
+
+# Returns (count, kind) from the value of --noise
+def parse_noise_option(value):
+    count, _, kind = value.partition(":")
+    kind = kind or "busy"
+    try:
+        count = int(count) if count else 1
+    except ValueError:
+        count = 0
+    if count < 1 or kind not in noise_programs:
+        print(f"Invalid --noise value: {value}\n")
+        print_usage()
+        sys.exit(1)
+    return count, kind
+
+def parse_placement_option(value):
+    placements = value.split(",") if value else placement_policies
+    for placement in placements:
+        if placement not in placement_policies:
+            print(f"Unknown placement policy: {placement}\n")
+            print_usage()
+            sys.exit(1)
+    if shutil.which("taskset") is None and placements != ["none"]:
+        print("--placement requires taskset")
+        sys.exit(1)
+    if placements != ["none"] and not get_cpu_topology():
+        print("--placement requires the CPU topology from lscpu")
+        sys.exit(1)
+    return placements
+
+# Returns a list of (runtime, benchmark or None, threads or None) from the value of
+# --profile, where None selects the default
+def parse_profile_option(value):
+    all_runtimes = [runtime for runtime_names in runtimes.values() for runtime in runtime_names]
+    selections = []
+    for item in value.split(",") if value else []:
+        fields = item.split(":")
+        runtime = fields[0]
+        bench_name = fields[1] if len(fields) > 1 and fields[1] else None
+        threads = fields[2] if len(fields) > 2 else None
+        if (runtime not in all_runtimes or len(fields) > 3
+                or (bench_name is not None and bench_name not in benchmarks)
+                or (threads is not None and not threads.isdigit())):
+            print(f"Invalid --profile selection: {item}\n")
+            print_usage()
+            sys.exit(1)
+        selections.append((runtime, bench_name, int(threads) if threads else None))
+    if shutil.which("perf") is None:
+        print("--profile requires perf")
+        sys.exit(1)
+    # Above 2, perf can't sample an unprivileged process at all
+    try:
+        with open("/proc/sys/kernel/perf_event_paranoid") as paranoid_file:
+            paranoid = int(paranoid_file.read())
+    except (OSError, ValueError):
+        paranoid = None
+    if paranoid is not None and paranoid > 2 and os.geteuid() != 0:
+        print(f"--profile requires kernel.perf_event_paranoid <= 2 (it is {paranoid})")
+        sys.exit(1)
+    return selections
+
 def parse_args():
-    args = sys.argv[1:]
+    options, args = parse_options(sys.argv[1:])
+    result = parse_mode_args(args)
+    result["options"] = options
+    if "noise" in options:
+        result["noise"] = parse_noise_option(options["noise"])
+    if "profile" in options:
+        result["profile"] = parse_profile_option(options["profile"])
+    result["placements"] = parse_placement_option(options["placement"]) if "placement" in options else ["none"]
+    return result
+
+def parse_mode_args(args):
     all_runtimes = [runtime for runtime_names in runtimes.values() for runtime in runtime_names]
 
     if not args:
@@ -158,7 +412,18 @@ collect_results = {
     "nqueens": [{"params": ""}],
     "matmul": [{"params": "2048"}],
     "channel": [{"params": ""}],
-    "io_socket_st": [{"params": ""}]
+    "io_socket_st": [{"params": ""}],
+    "sync": [{"params": "256"}],
+    "flat_spawn": [{"params": ""}],
+    "pipeline": [{"params": ""}],
+    "generator": [{"params": "8"}],
+    "timer": [{"params": "100000"}],
+    "nqueens_first": [{"params": ""}],
+    "exception_storm": [{"params": "10000"}],
+    "when_any": [{"params": "32"}],
+    "priority": [{"params": ""}],
+    "blocking": [{"params": "10"}],
+    "hop": [{"params": "32"}]
 }
 
 # Fallback to a shell script for hardware core count detection if the user didn't build TMC
@@ -260,8 +525,57 @@ def build_runtime(language, runtime, library_ref=None, clean_build=False):
         return False
     return True
 
-def run_runtime_benchmarks(language, runtime, result_runtime_name, threads):
-    for bench_name in benchmarks_order:
+# Returns a list of (cpu, core, node, llc) for each CPU, where llc identifies the
+# last-level cache domain. Returns an empty list if lscpu isn't available.
+def get_cpu_topology():
+    try:
+        out = subprocess.run(args="lscpu -p=CPU,CORE,NODE,CACHE", shell=True, capture_output=True, text=True).stdout
+    except:
+        return []
+    to_int = lambda field: int(field) if field.isdigit() else 0
+    topology = []
+    for line in out.splitlines():
+        if line.startswith("#"):
+            continue
+        fields = line.split(",")
+        topology.append((to_int(fields[0]), to_int(fields[1]), to_int(fields[2]), to_int(fields[-1])))
+    return topology
+
+# Returns the CPUs that the given placement policy uses for thread_count threads,
+# or None if the benchmark should run unrestricted.
+def get_placement_cpus(placement, thread_count, topology):
+    if placement == "none" or not topology:
+        return None
+    if placement == "numa":
+        cpus = [cpu for cpu, core, node, llc in sorted(topology, key=lambda t: (t[2], t[1], t[0]))]
+        return sorted(cpus[:thread_count])
+
+    # The first CPU of each core, in core order; the SMT siblings are only used if
+    # there are more threads than cores
+    first_cpus = []
+    siblings = []
+    seen_cores = set()
+    for cpu, core, node, llc in sorted(topology, key=lambda t: (t[1], t[0])):
+        if core in seen_cores:
+            siblings.append(cpu)
+        else:
+            seen_cores.add(core)
+            first_cpus.append((cpu, llc))
+    if placement == "l3":
+        first_cpus.sort(key=lambda c: c[1])
+    elif placement == "spread":
+        domains = {}
+        for cpu, llc in first_cpus:
+            domains.setdefault(llc, []).append((cpu, llc))
+        first_cpus = []
+        domain_lists = list(domains.values())
+        for i in range(max(len(d) for d in domain_lists)):
+            first_cpus += [d[i] for d in domain_lists if i < len(d)]
+    cpus = [cpu for cpu, llc in first_cpus] + siblings
+    return sorted(cpus[:thread_count])
+
+def run_runtime_benchmarks(language, runtime, result_runtime_name, threads, bench_names=benchmarks_order):
+    for bench_name in bench_names:
         # lowest_dur = sys.maxsize
         bench_args = benchmarks[bench_name]
         runtime_root_dir = os.path.join(root_dir, language, runtime)
@@ -269,52 +583,412 @@ def run_runtime_benchmarks(language, runtime, result_runtime_name, threads):
 
         # Get configs for this runtime+benchmark combo, or use a single empty config
         configs = benchmark_configs.get(runtime, {}).get(bench_name, [""])
+        configs = configs + [config for config in common_benchmark_configs.get(bench_name, []) if config not in configs]
 
         # Skip if benchmark executable doesn't exist
         if not os.path.exists(bench_exe):
             continue
 
         for config in configs:
+             config_exe = config_executables.get(runtime, {}).get(bench_name, {}).get(config)
+             run_exe = os.path.join(runtime_root_dir, "build", config_exe) if config_exe else bench_exe
+             if not os.path.exists(run_exe):
+                 continue
              for params in bench_args.setdefault("params",[""]):
                  for thread_count in threads:
-                     one_run = {
-                         "params": params,
-                         "threads": thread_count,
-                         "config": config,
-                     }
-                     # Build command: exe params threads [config]
-                     cmd = f"{bench_exe} {params} {thread_count}"
-                     if config:
-                         cmd += f" {config}"
-
-                     print(f"Running {cmd}")
-                     output_array = subprocess.run(args=cmd, shell=True, capture_output=True, text=True)
-                     try:
-                         print(output_array.stdout)
-                         raw = yaml.safe_load(output_array.stdout)
-                         run_data = raw["runs"][0]
-
-                         result = {
-                             "duration": run_data["duration"]
+                     for placement in args["placements"]:
+                         one_run = {
+                             "params": params,
+                             "threads": thread_count,
+                             "config": config,
                          }
-                         # Extract max_rss
-                         if "max_rss" in run_data:
-                             result["max_rss"] = format_mem(run_data["max_rss"])
-
-                         # Extract throughput (any field ending in /sec)
-                         for key, value in run_data.items():
-                             if key.endswith("/sec"):
-                                 result["throughput"] = value
-                                 break
-                         one_run["result"] = result
-                         # Use config-suffixed runtime name if config is specified
-                         result_runtime = result_runtime_name if not config else f"{result_runtime_name}_{config}"
-                         full_results.setdefault(result_runtime, {}).setdefault(bench_name, []).append(one_run)
-                     except (yaml.YAMLError, Exception) as exc:
-                         print(f"Skipping result: {exc}")
-                         continue
+                         # Build command: exe params threads [config]
+                         cmd = f"{run_exe} {params} {thread_count}"
+                         if config:
+                             cmd += f" {config}"
+                         if "placement" in args["options"]:
+                             one_run["placement"] = placement
+                         cpus = get_placement_cpus(placement, thread_count, cpu_topology)
+                         if cpus is not None:
+                             one_run["cpus"] = cpus
+                             cmd = f"taskset -c {','.join(str(cpu) for cpu in cpus)} {cmd}"
+
+                         print(f"Running {cmd}")
+                         try:
+                             one_run["result"] = run_benchmark_cmd(cmd)
+                             # Use config-suffixed runtime name if config is specified
+                             result_runtime = result_runtime_name if not config else f"{result_runtime_name}_{config}"
+                             if placement != "none":
+                                 result_runtime += f"_{placement}"
+                             full_results.setdefault(result_runtime, {}).setdefault(bench_name, []).append(one_run)
+                         except (yaml.YAMLError, Exception) as exc:
+                             print(f"Skipping result: {exc}")
+                             continue
+                         if "noise" in args:
+                             run_with_noise(cmd, one_run, result_runtime, bench_name)
+
+# Runs one benchmark command and parses its output into a result
+def run_benchmark_cmd(cmd):
+    output_array = subprocess.run(args=cmd, shell=True, capture_output=True, text=True)
+    print(output_array.stdout)
+    raw = yaml.safe_load(output_array.stdout)
+    run_data = raw["runs"][0]
+
+    result = {
+        "duration": run_data["duration"]
+    }
+    # Extract max_rss
+    if "max_rss" in run_data:
+        result["max_rss"] = format_mem(run_data["max_rss"])
+
+    # Extract throughput (any field ending in /sec)
+    for key, value in run_data.items():
+        if key.endswith("/sec"):
+            result["throughput"] = value
+            break
+    # Keep any other metrics the benchmark reports (e.g. submit_duration)
+    metrics = {
+        key: value for key, value in run_data.items()
+        if key not in ("iteration_count", "duration", "max_rss")
+    }
+    if metrics:
+        result["metrics"] = metrics
+    return result
+
+@contextlib.contextmanager
+def noise_load(count, kind):
+    cpus = sorted(os.sched_getaffinity(0)) if hasattr(os, "sched_getaffinity") else []
+    procs = []
+    for i in range(count):
+        pin = None
+        if cpus:
+            cpu = cpus[-1 - (i % len(cpus))]
+            pin = lambda cpu=cpu: os.sched_setaffinity(0, {cpu})
+        procs.append(subprocess.Popen([sys.executable, "-c", noise_programs[kind]], preexec_fn=pin))
+    # Let the loads get going before the benchmark starts
+    time.sleep(0.5)
+    try:
+        yield
+    finally:
+        for proc in procs:
+            proc.kill()
+        for proc in procs:
+            proc.wait()
+
+# Reruns a benchmark under the --noise load. The result is stored under the runtime
+# name suffixed with "_noise" and includes the slowdown relative to the quiet run.
+def run_with_noise(cmd, quiet_run, result_runtime, bench_name):
+    count, kind = args["noise"]
+    print(f"Running {cmd} with {count} {kind} noise processes")
+    try:
+        with noise_load(count, kind):
+            result = run_benchmark_cmd(cmd)
+    except (yaml.YAMLError, Exception) as exc:
+        print(f"Skipping noise result: {exc}")
+        return
+    quiet_dur = get_dur_in_us(quiet_run["result"]["duration"])
+    result["slowdown"] = round(get_dur_in_us(result["duration"]) / quiet_dur, 2)
+    print(f"Slowdown: {result['slowdown']}x")
+    noisy_run = dict(quiet_run, result=result)
+    full_results.setdefault(f"{result_runtime}_noise", {}).setdefault(bench_name, []).append(noisy_run)
+
+# Runs the fork-join benchmarks with more threads than the largest thread count
+def run_oversubscribed(language, runtime, result_runtime_name, threads):
+    for factor in oversubscription_factors:
+        run_runtime_benchmarks(language, runtime, f"{result_runtime_name}_oversub{factor}x",
+                               [threads[-1] * factor], fork_join_benchmarks)
+
+# Runs the fork-join benchmarks at the largest thread count with each grain size in
+# cutoff_sweep. Each run records its grain size in "cutoff".
+def run_cutoff_sweep(language, runtime, result_runtime_name, threads):
+    for bench_name in fork_join_benchmarks:
+        bench_exe = os.path.join(root_dir, language, runtime, "build", bench_name)
+        if not os.path.exists(bench_exe):
+            continue
+        params = collect_results[bench_name][0]["params"]
+        for cutoff in cutoff_sweep[bench_name]:
+            cmd = f"CUTOFF={cutoff} {bench_exe} {params} {threads[-1]}"
+            print(f"Running {cmd}")
+            try:
+                result = run_benchmark_cmd(cmd)
+            except (yaml.YAMLError, Exception) as exc:
+                print(f"Skipping result: {exc}")
+                continue
+            one_run = {
+                "params": params,
+                "threads": threads[-1],
+                "config": "",
+                "cutoff": cutoff,
+                "result": result,
+            }
+            full_results.setdefault(f"{result_runtime_name}_cutoff", {}).setdefault(bench_name, []).append(one_run)
+
+# Writes CUTOFF_<benchmark>.svg for each benchmark run by --cutoff, with a line per
+# runtime of its duration at each grain size.
+def write_cutoff_plots():
+    colors = ["#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd", "#8c564b",
+              "#e377c2", "#7f7f7f", "#bcbd22", "#17becf", "#000000", "#aec7e8"]
+    width, height, left, right, top, bottom = 720, 420, 70, 170, 30, 50
+    for bench_name in fork_join_benchmarks:
+        lines = {}
+        for runtime, runtime_results in full_results.items():
+            if runtime.endswith("_cutoff") and bench_name in runtime_results:
+                lines[runtime[:-len("_cutoff")]] = {
+                    run["cutoff"]: get_dur_in_us(run["result"]["duration"]) / 1000.0
+                    for run in runtime_results[bench_name]
+                }
+        if not lines:
+            continue
+        cutoffs = cutoff_sweep[bench_name]
+        max_ms = max(ms for points in lines.values() for ms in points.values()) or 1.0
+        plot_w = width - left - right
+        plot_h = height - top - bottom
+        x_of = lambda i: left + (plot_w * i / (len(cutoffs) - 1) if len(cutoffs) > 1 else plot_w / 2)
+        y_of = lambda ms: top + plot_h - plot_h * ms / max_ms
+        svg = [f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" height="{height}" font-family="sans-serif" font-size="12">',
+               f'<text x="{left}" y="18">{bench_name}: duration (ms) vs cutoff</text>',
+               f'<line x1="{left}" y1="{top + plot_h}" x2="{left + plot_w}" y2="{top + plot_h}" stroke="black"/>',
+               f'<line x1="{left}" y1="{top}" x2="{left}" y2="{top + plot_h}" stroke="black"/>']
+        for i, cutoff in enumerate(cutoffs):
+            svg.append(f'<text x="{x_of(i):.1f}" y="{top + plot_h + 18}" text-anchor="middle">{cutoff}</text>')
+        for i in range(5):
+            ms = max_ms * i / 4
+            svg.append(f'<text x="{left - 6}" y="{y_of(ms) + 4:.1f}" text-anchor="end">{ms:.1f}</text>')
+        for n, (runtime, points) in enumerate(lines.items()):
+            color = colors[n % len(colors)]
+            coords = " ".join(f"{x_of(i):.1f},{y_of(points[c]):.1f}" for i, c in enumerate(cutoffs) if c in points)
+            svg.append(f'<polyline points="{coords}" fill="none" stroke="{color}" stroke-width="2"/>')
+            svg.append(f'<text x="{left + plot_w + 10}" y="{top + 14 * n + 10}" fill="{color}">{runtime}</text>')
+        svg.append("</svg>")
+        with open(f"CUTOFF_{bench_name}.svg", "w") as svg_file:
+            svg_file.write("\n".join(svg) + "\n")
+        print(f"Wrote CUTOFF_{bench_name}.svg")
+
+# Builds runtime with profile_preset into profile_build_dir, next to its release build
+def build_runtime_for_profile(language, runtime):
+    runtime_root_dir = os.path.join(root_dir, language, runtime)
+    print(f"Building {runtime} for profiling")
+    cmd = (f"cmake --preset {profile_preset} -B {profile_build_dir} . && "
+           f"cmake --build ./{profile_build_dir} --parallel 16 --target all")
+    result = subprocess.run(args=cmd, shell=True, cwd=runtime_root_dir, capture_output=True, text=True)
+    if result.returncode != 0:
+        print(f"Build failed for {runtime}:")
+        print(result.stdout)
+        print(result.stderr)
+        return False
+    return True
+
+# Returns the folded stacks ("root;...;leaf" -> sample count) of perf script output,
+# like FlameGraph's stackcollapse-perf.pl. Each sample is a header line naming the
+# thread, followed by one indented line per frame from the leaf up.
+def fold_perf_script(text):
+    folded = {}
+    comm = None
+    frames = []
+    for line in text.splitlines() + [""]:
+        if not line.strip():
+            if comm is not None:
+                stack = ";".join([comm] + frames[::-1])
+                folded[stack] = folded.get(stack, 0) + 1
+            comm = None
+            frames = []
+        elif not re.match(r"\s+[0-9a-f]+(\s|$)", line):
+            # "comm pid[/tid] ...", where comm may contain spaces and may be
+            # right-aligned
+            match = re.match(r"\s*(\S.*?)\s+\d+(/\d+)?\s", line)
+            comm = match.group(1) if match else line.split()[0]
+        elif comm is not None:
+            # "    addr symbol+0xoff (dso)"
+            fields = line.split(None, 1)
+            symbol = fields[1].rsplit(" (", 1)[0] if len(fields) > 1 else "[unknown]"
+            if "+0x" in symbol:
+                symbol = symbol[:symbol.rindex("+0x")]
+            frames.append(symbol.replace(";", ":"))
+    return folded
+
+# Writes a flamegraph of the folded stacks as an SVG. Each frame's width is its share
+# of the samples; frames narrower than a pixel are dropped.
+def write_flamegraph(folded, path, title):
+    width, frame_h, top = 1200, 16, 30
+    tree = {"count": 0, "children": {}}
+    for stack, count in folded.items():
+        node = tree
+        node["count"] += count
+        for frame in stack.split(";"):
+            node = node["children"].setdefault(frame, {"count": 0, "children": {}})
+            node["count"] += count
+    total = tree["count"] or 1
+
+    def depth_of(node):
+        return 1 + max((depth_of(child) for child in node["children"].values()), default=0)
+    depth = depth_of(tree) - 1
+    height = top + depth * frame_h + 10
+
+    rects = []
+    def place(node, x, level):
+        for name, child in sorted(node["children"].items()):
+            w = width * child["count"] / total
+            if w >= 1:
+                rects.append((name, child["count"], x, level, w))
+                place(child, x, level + 1)
+            x += w
+    place(tree, 0.0, 0)
+
+    escape = lambda text: text.replace("&", "&amp;").replace("<", "&lt;").replace(">", "&gt;")
+    svg = [f'<svg xmlns="http://www.w3.org/2000/svg" width="{width}" height="{height}" font-family="monospace" font-size="11">',
+           f'<text x="{width / 2}" y="18" text-anchor="middle" font-family="sans-serif" font-size="14">{escape(title)}</text>']
+    for name, count, x, level, w in rects:
+        y = top + (depth - level - 1) * frame_h
+        # A stable warm color per function name
+        h = sum(ord(c) for c in name)
+        color = f"rgb({205 + h % 50},{80 + (h * 7) % 120},{(h * 13) % 55})"
+        label = escape(name)
+        chars = int((w - 6) / 7)
+        text = label if len(name) <= chars else (escape(name[:chars - 2]) + ".." if chars > 2 else "")
+        svg.append(f'<g><title>{label} ({count} samples, {100.0 * count / total:.2f}%)</title>'
+                   f'<rect x="{x:.1f}" y="{y}" width="{w:.1f}" height="{frame_h - 1}" fill="{color}"/>'
+                   f'<text x="{x + 3:.1f}" y="{y + frame_h - 4}">{text}</text></g>')
+    svg.append("</svg>")
+    with open(path, "w") as svg_file:
+        svg_file.write("\n".join(svg) + "\n")
+
+# Returns the (language, runtime, benchmark, threads) runs selected by --profile
+def get_profile_runs(threads):
+    selections = args["profile"]
+    if not selections:
+        selections = [(runtime, None, None) for runtime_names in active_runtimes.values() for runtime in runtime_names]
+    runs = []
+    for runtime, bench_name, thread_count in selections:
+        language = get_language_for_runtime(runtime)
+        for bench in [bench_name] if bench_name else fork_join_benchmarks:
+            run = (language, runtime, bench, thread_count or threads[-1])
+            if run not in runs:
+                runs.append(run)
+    return runs
+
+# Runs the benchmarks selected by --profile under perf record and writes their folded
+# stacks and flamegraphs to profile_dir. Returns a list describing each profile.
+def run_profiles(threads):
+    os.makedirs(profile_dir, exist_ok=True)
+    profiles = []
+    built = {}
+    for language, runtime, bench_name, thread_count in get_profile_runs(threads):
+        if runtime not in built:
+            built[runtime] = build_runtime_for_profile(language, runtime)
+        bench_exe = os.path.join(root_dir, language, runtime, profile_build_dir, bench_name)
+        if not built[runtime] or not os.path.exists(bench_exe):
+            continue
+        params = collect_results[bench_name][0]["params"]
+        name = f"{runtime}_{bench_name}_{thread_count}"
+        perf_data = os.path.join(profile_dir, f"{name}.perf.data")
+        cmd = f"perf record {profile_perf_args} -o {perf_data} -- {bench_exe} {params} {thread_count}"
+        print(f"Running {cmd}")
+        result = subprocess.run(args=cmd, shell=True, capture_output=True, text=True)
+        if result.returncode != 0:
+            print(f"Skipping profile: {result.stderr}")
+            continue
+        script = subprocess.run(args=f"perf script -i {perf_data}", shell=True, capture_output=True, text=True)
+        if script.returncode != 0:
+            print(f"Skipping profile: {script.stderr}")
+            continue
+        folded = fold_perf_script(script.stdout)
+        if not folded:
+            print(f"Skipping profile: no samples in {perf_data}")
+            continue
+        with open(os.path.join(profile_dir, f"{name}.folded"), "w") as folded_file:
+            for stack, count in sorted(folded.items()):
+                folded_file.write(f"{stack} {count}\n")
+        svg = os.path.join(profile_dir, f"{name}.svg")
+        write_flamegraph(folded, svg, f"{runtime} {bench_name} {params} ({thread_count} threads)".replace("  ", " "))
+        print(f"Wrote {svg}")
+        profiles.append({"runtime": runtime, "benchmark": bench_name, "params": params,
+                         "threads": thread_count, "svg": svg.replace(os.sep, "/")})
+    return profiles
+
+# Builds and runs the serial reference on a single thread, with each of the common
+# configs but no placement or noise reruns. Every run is stored under serial_runtime,
+# with its config recorded in the run rather than in the name.
+def run_serial_reference():
+    if not build_runtime("cpp", serial_runtime):
+        return
+    for bench_name in fork_join_benchmarks:
+        bench_exe = os.path.join(root_dir, "cpp", serial_runtime, "build", bench_name)
+        if not os.path.exists(bench_exe):
+            continue
+        for config in [""] + common_benchmark_configs.get(bench_name, []):
+            for params in benchmarks[bench_name].setdefault("params", [""]):
+                cmd = f"{bench_exe} {params} 1"
+                if config:
+                    cmd += f" {config}"
+                print(f"Running {cmd}")
+                try:
+                    result = run_benchmark_cmd(cmd)
+                except (yaml.YAMLError, Exception) as exc:
+                    print(f"Skipping result: {exc}")
+                    continue
+                one_run = {"params": params, "threads": 1, "config": config, "result": result}
+                full_results.setdefault(serial_runtime, {}).setdefault(bench_name, []).append(one_run)
+
+# Records the overhead and efficiency of each fork-join run relative to the serial
+# reference, as described at serial_runtime
+def add_serial_ratios():
+    serial_durs = {}
+    for bench_name, runs in full_results.get(serial_runtime, {}).items():
+        for run in runs:
+            key = (bench_name, run["params"], run["config"])
+            serial_durs[key] = get_dur_in_us(run["result"]["duration"])
+    for runtime, runtime_results in full_results.items():
+        if runtime == serial_runtime:
+            continue
+        for bench_name in fork_join_benchmarks:
+            for run in runtime_results.get(bench_name, []):
+                config = run["config"]
+                if config not in common_benchmark_configs.get(bench_name, []):
+                    config = ""
+                serial_dur = serial_durs.get((bench_name, run["params"], config))
+                if serial_dur is None:
+                    continue
+                dur = get_dur_in_us(run["result"]["duration"])
+                run["result"]["efficiency"] = round(serial_dur / (run["threads"] * dur), 2)
+                if run["threads"] == 1:
+                    run["result"]["overhead"] = round(dur / serial_dur, 2)
+
+# Records the throughput of each blocking run relative to the 0% run of the same
+# runtime, config and thread count, as "relative_throughput"
+def add_blocking_degradation():
+    for runtime_results in full_results.values():
+        runs = runtime_results.get("blocking", [])
+        base_durs = {}
+        for run in runs:
+            if run["params"] == "0":
+                key = (run["threads"], run["config"], run.get("placement"))
+                base_durs[key] = get_dur_in_us(run["result"]["duration"])
+        for run in runs:
+            base_dur = base_durs.get((run["threads"], run["config"], run.get("placement")))
+            if base_dur is None:
+                continue
+            dur = get_dur_in_us(run["result"]["duration"])
+            run["result"]["relative_throughput"] = round(base_dur / dur, 2)
+
+# Whether the results stored under runtime are a reference or a variant of another
+# runtime's runs, which are reported in their own views rather than ranked and
+# collated alongside the runtimes
+def is_variant_runtime(runtime):
+    if runtime == serial_runtime or runtime.endswith(("_noise", "_cutoff")):
+        return True
+    # the config and placement suffixes follow the oversubscription suffix
+    return re.search(r"_oversub\d+x(_|$)", runtime) is not None
+
+def run_all_benchmarks(language, runtime, result_runtime_name, threads):
+    run_runtime_benchmarks(language, runtime, result_runtime_name, threads)
+    if "oversub" in args["options"]:
+        run_oversubscribed(language, runtime, result_runtime_name, threads)
+    if "cutoff" in args["options"]:
+        run_cutoff_sweep(language, runtime, result_runtime_name, threads)
 
 args = parse_args()
+md["options"] = args["options"]
+cpu_topology = get_cpu_topology() if args["placements"] != ["none"] else []
 compare_mode = args["compare_runtime"] is not None
 single_runtime_mode = args["single_runtime"] is not None
 active_runtimes = runtimes
@@ -340,7 +1014,7 @@ if compare_mode:
 
     for result_runtime_name, library_ref in compare_runs:
         if build_runtime(language, compare_runtime, library_ref=library_ref, clean_build=True):
-            run_runtime_benchmarks(language, compare_runtime, result_runtime_name, threads)
+            run_all_benchmarks(language, compare_runtime, result_runtime_name, threads)
 elif single_runtime_mode:
     single_runtime = args["single_runtime"]
     single_ref = args["single_ref"]
@@ -349,7 +1023,7 @@ elif single_runtime_mode:
     print(f"Threads sweep: {threads}")
 
     if build_runtime(language, single_runtime, library_ref=single_ref, clean_build=single_ref is not None):
-        run_runtime_benchmarks(language, single_runtime, single_runtime, threads)
+        run_all_benchmarks(language, single_runtime, single_runtime, threads)
 else:
     for language, runtime_names in active_runtimes.items():
         for runtime in runtime_names:
@@ -360,32 +1034,46 @@ else:
     print(f"Threads sweep: {threads}")
     for language, runtime_names in active_runtimes.items():
         for runtime in runtime_names:
-            run_runtime_benchmarks(language, runtime, runtime, threads)
+            run_all_benchmarks(language, runtime, runtime, threads)
+
+# The serial reference only feeds the comparison across runtimes, so it isn't
+# built or run when a single runtime is benchmarked or compared between refs
+if not compare_mode and not single_runtime_mode:
+    run_serial_reference()
+    add_serial_ratios()
+add_blocking_degradation()
+
+if "cutoff" in args["options"]:
+    write_cutoff_plots()
 
+if "profile" in args:
+    md["profiles"] = run_profiles(threads)
 
+# Runs with different params (e.g. matmul sizes) do different amounts of work,
+# so both the best duration and the speedup baseline are kept per params.
 for bench_name in benchmarks_order:
-    lowest_dur = sys.maxsize
+    lowest_dur = {}
     for runtime, runtime_results in full_results.items():
-        if bench_name not in runtime_results:
+        if bench_name not in runtime_results or is_variant_runtime(runtime):
             continue
         for run in runtime_results[bench_name]:
             dur = get_dur_in_us(run["result"]["duration"])
-            if (dur < lowest_dur):
-                lowest_dur = dur
-    if lowest_dur == sys.maxsize:
+            if (dur < lowest_dur.get(run["params"], sys.maxsize)):
+                lowest_dur[run["params"]] = dur
+    if not lowest_dur:
         continue
     for runtime, runtime_results in full_results.items():
-        if bench_name not in runtime_results:
+        if bench_name not in runtime_results or is_variant_runtime(runtime):
             continue
-        firstDur = None
-        for i, run in enumerate(runtime_results[bench_name]):
+        # the first run for each params is at the lowest thread count
+        firstDur = {}
+        for run in runtime_results[bench_name]:
             dur = get_dur_in_us(run["result"]["duration"])
-            scaled = float(dur) / float(lowest_dur)
+            scaled = float(dur) / float(lowest_dur[run["params"]])
             scaled = round(scaled, 2)
             run["result"]["scaled"] = scaled
-            if i == 0:
-                firstDur = dur
-            speedup = float(firstDur) / float(dur)
+            firstDur.setdefault(run["params"], dur)
+            speedup = float(firstDur[run["params"]]) / float(dur)
             speedup = round(speedup, 2)
             run["result"]["speedup"] = speedup
 
@@ -394,6 +1082,8 @@ for bench_name in benchmarks_order:
 collated_results = {}
 bench_names = []
 for runtime, runtime_results in full_results.items():
+    if is_variant_runtime(runtime):
+        continue
     for bench_name in benchmarks_order:
         if bench_name not in runtime_results:
             continue
@@ -590,6 +1280,119 @@ for y in range(len(mem_table[0])):
             outMD += "| --- "
         outMD += "|\n"
 
+# --- Generate Overhead vs Serial Table ---
+# Each cell is the overhead at 1 thread (only measured by a full sweep) and the
+# parallel efficiency at the largest thread count
+serial_bench_names = [b for b in bench_names if b.split("(")[0] in fork_join_benchmarks]
+serial_table = [["Runtime"] + serial_bench_names]
+for runtime in collated_results.keys():
+    row = [runtime]
+    for bench_friendly in serial_bench_names:
+        orig = bench_friendly.split("(")[0]
+        params = collect_results[orig][0]["params"]
+        runs = [run for run in full_results[runtime].get(orig, []) if run["params"] == params]
+        if not runs or "efficiency" not in runs[-1]["result"]:
+            row.append("N/A")
+            continue
+        overhead = next((f"{run['result']['overhead']:.2f}x" for run in runs if "overhead" in run["result"]), "N/A")
+        row.append(f"{overhead} / {round(runs[-1]['result']['efficiency'] * 100)}%")
+    if any(cell != "N/A" for cell in row[1:]):
+        serial_table.append(row)
+
+if len(serial_table) > 1:
+    outMD += "\n\n### Overhead vs Serial (1 thread overhead / parallel efficiency)\n\n"
+    for y in range(len(serial_table[0])):
+        for x in range(len(serial_table)):
+            outMD += f"| {serial_table[x][y]} "
+        outMD += "|\n"
+        if y == 0: # Header separator
+            for _ in range(len(serial_table)):
+                outMD += "| --- "
+            outMD += "|\n"
+
+# --- Generate Worker Utilization Table ---
+# The fork-join benchmarks report how busy their workers were during the timed
+# region (see cpp/2common/utilization.hpp). Each cell is the mean busy percentage
+# and the imbalance (Gini coefficient) at the largest thread count, to tell load
+# imbalance apart from contention where a runtime scales poorly.
+util_table = [["Runtime"] + serial_bench_names]
+for runtime in collated_results.keys():
+    row = [runtime]
+    for bench_friendly in serial_bench_names:
+        orig = bench_friendly.split("(")[0]
+        params = collect_results[orig][0]["params"]
+        runs = [run for run in full_results[runtime].get(orig, []) if run["params"] == params]
+        metrics = runs[-1]["result"].get("metrics", {}) if runs else {}
+        if "busy_mean_pct" not in metrics:
+            row.append("N/A")
+            continue
+        row.append(f"{round(metrics['busy_mean_pct'])}% / {metrics['imbalance_gini']:.2f}")
+    if any(cell != "N/A" for cell in row[1:]):
+        util_table.append(row)
+
+if len(util_table) > 1:
+    outMD += "\n\n### Worker Utilization (mean busy / imbalance)\n\n"
+    for y in range(len(util_table[0])):
+        for x in range(len(util_table)):
+            outMD += f"| {util_table[x][y]} "
+        outMD += "|\n"
+        if y == 0: # Header separator
+            for _ in range(len(util_table)):
+                outMD += "| --- "
+            outMD += "|\n"
+
+# --- Generate Blocking Degradation Table ---
+# Each cell is a blocking run's throughput relative to the same runtime's 0% run,
+# at the largest thread count
+blocking_params = [p for p in benchmarks["blocking"]["params"] if p != "0"]
+blocking_table = [["Runtime"] + [f"{p}% blocking" for p in blocking_params]]
+for runtime in collated_results.keys():
+    row = [runtime]
+    for params in blocking_params:
+        runs = [run for run in full_results[runtime].get("blocking", []) if run["params"] == params]
+        if not runs or "relative_throughput" not in runs[-1]["result"]:
+            row.append("N/A")
+            continue
+        row.append(f"{round(runs[-1]['result']['relative_throughput'] * 100)}%")
+    if any(cell != "N/A" for cell in row[1:]):
+        blocking_table.append(row)
+
+if len(blocking_table) > 1:
+    outMD += "\n\n### Blocking Throughput (relative to 0% blocking)\n\n"
+    for y in range(len(blocking_table[0])):
+        for x in range(len(blocking_table)):
+            outMD += f"| {blocking_table[x][y]} "
+        outMD += "|\n"
+        if y == 0: # Header separator
+            for _ in range(len(blocking_table)):
+                outMD += "| --- "
+            outMD += "|\n"
+
+# --- Generate Noise Slowdown Table ---
+# With --noise, each cell is the slowdown of a runtime's run alongside the background
+# load, relative to the same run without it
+noise_table = [["Runtime"] + bench_names]
+for runtime in collated_results.keys():
+    row = [runtime]
+    for bench_friendly in bench_names:
+        orig = bench_friendly.split("(")[0]
+        params = collect_results[orig][0]["params"]
+        runs = [run for run in full_results.get(f"{runtime}_noise", {}).get(orig, []) if run["params"] == params]
+        row.append(f"{runs[-1]['result']['slowdown']:.2f}x" if runs else "N/A")
+    if any(cell != "N/A" for cell in row[1:]):
+        noise_table.append(row)
+
+if len(noise_table) > 1:
+    outMD += "\n\n### Slowdown Under Noise\n\n"
+    for y in range(len(noise_table[0])):
+        for x in range(len(noise_table)):
+            outMD += f"| {noise_table[x][y]} "
+        outMD += "|\n"
+        if y == 0: # Header separator
+            for _ in range(len(noise_table)):
+                outMD += "| --- "
+            outMD += "|\n"
+
 with open("RESULTS.md", "w") as resultsMD:
     resultsMD.write(outMD.strip() + "\n")
 
@@ -5,6 +5,23 @@ rm -rf ./cpp/cppcoro/build
 rm -rf ./cpp/HPX/build
 rm -rf ./cpp/libcoro/build
 rm -rf ./cpp/libfork/build
+rm -rf ./cpp/openmp/build
+rm -rf ./cpp/refsched/build
+rm -rf ./cpp/serial/build
 rm -rf ./cpp/taskflow/build
 rm -rf ./cpp/tbb/build
 rm -rf ./cpp/TooManyCooks/build
+rm -rf ./cpp/cobalt/build_profile
+rm -rf ./cpp/concurrencpp/build_profile
+rm -rf ./cpp/coros/build_profile
+rm -rf ./cpp/cppcoro/build_profile
+rm -rf ./cpp/HPX/build_profile
+rm -rf ./cpp/libcoro/build_profile
+rm -rf ./cpp/libfork/build_profile
+rm -rf ./cpp/openmp/build_profile
+rm -rf ./cpp/refsched/build_profile
+rm -rf ./cpp/serial/build_profile
+rm -rf ./cpp/taskflow/build_profile
+rm -rf ./cpp/tbb/build_profile
+rm -rf ./cpp/TooManyCooks/build_profile
+rm -rf ./profiles
@@ -0,0 +1,139 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Counts heap allocations made through the global operator new, which is what
+// coroutine frames use unless the promise type overrides it.
+// Include this header in exactly one translation unit of the executable,
+// since it replaces the global operator new and delete.
+//
+// Besides the totals, it tracks the number of live allocations and its high
+// water mark, and a histogram of allocation sizes. In a benchmark that spawns
+// a coroutine per task, the most common size is the size of the frame and the
+// high water mark is the most frames alive at once. The live count is a single
+// atomic shared by all threads, so timings taken with this header included are
+// not comparable to uninstrumented ones.
+
+// Each thread owns one slot and is the only writer to it, so incrementing
+// doesn't need an atomic RMW. Slots are never freed so that counts from
+// exited threads are kept.
+// Sizes up to alloc_size_buckets - 1 are counted exactly; larger ones share the
+// last bucket.
+inline constexpr size_t alloc_size_buckets = 4096;
+
+struct alloc_count_slot {
+  std::atomic<size_t> count{0};
+  std::atomic<size_t> bytes{0};
+  std::atomic<size_t> sizes[alloc_size_buckets] = {};
+  alloc_count_slot* next = nullptr;
+};
+
+inline std::atomic<alloc_count_slot*> alloc_count_head{nullptr};
+inline std::atomic<size_t> alloc_count_live{0};
+inline std::atomic<size_t> alloc_count_peak{0};
+
+static inline alloc_count_slot& alloc_count_local() {
+  // Allocate the slot with malloc, since this is called from operator new.
+  thread_local alloc_count_slot* slot = [] {
+    auto* s = new (std::malloc(sizeof(alloc_count_slot))) alloc_count_slot;
+    s->next = alloc_count_head.load(std::memory_order_relaxed);
+    while (!alloc_count_head.compare_exchange_weak(
+      s->next, s, std::memory_order_release, std::memory_order_relaxed
+    )) {
+    }
+    return s;
+  }();
+  return *slot;
+}
+
+struct alloc_stats {
+  size_t count;
+  size_t bytes;
+  // The number of live allocations, and the most there were at once since the
+  // previous call to alloc_stats_now()
+  size_t live;
+  size_t peak;
+  // The number of allocations of each size so far
+  std::array<size_t, alloc_size_buckets> sizes;
+};
+
+// Returns the total allocations made by all threads so far. Take the difference
+// of two snapshots to get the allocations made during a region. This also
+// restarts the high water mark from the current live count, so the peak of the
+// second snapshot is the most that were live during the region.
+static inline alloc_stats alloc_stats_now() {
+  alloc_stats result{};
+  for (auto* s = alloc_count_head.load(std::memory_order_acquire); s != nullptr;
+       s = s->next) {
+    result.count += s->count.load(std::memory_order_relaxed);
+    result.bytes += s->bytes.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < alloc_size_buckets; ++i) {
+      result.sizes[i] += s->sizes[i].load(std::memory_order_relaxed);
+    }
+  }
+  result.live = alloc_count_live.load(std::memory_order_relaxed);
+  result.peak =
+    alloc_count_peak.exchange(result.live, std::memory_order_relaxed);
+  return result;
+}
+
+// Returns the most common size of the allocations made between Start and End,
+// or 0 if there were none.
+static inline size_t
+alloc_common_size(const alloc_stats& Start, const alloc_stats& End) {
+  size_t size = 0;
+  size_t most = 0;
+  for (size_t i = 0; i < alloc_size_buckets; ++i) {
+    size_t n = End.sizes[i] - Start.sizes[i];
+    if (n > most) {
+      most = n;
+      size = i;
+    }
+  }
+  return size;
+}
+
+void* operator new(std::size_t size) {
+  auto& slot = alloc_count_local();
+  slot.count.store(
+    slot.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed
+  );
+  slot.bytes.store(
+    slot.bytes.load(std::memory_order_relaxed) + size,
+    std::memory_order_relaxed
+  );
+  auto& bucket =
+    slot.sizes[size < alloc_size_buckets ? size : alloc_size_buckets - 1];
+  bucket.store(
+    bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed
+  );
+  size_t live = alloc_count_live.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t peak = alloc_count_peak.load(std::memory_order_relaxed);
+  while (live > peak && !alloc_count_peak.compare_exchange_weak(
+                          peak, live, std::memory_order_relaxed
+                        )) {
+  }
+  if (size == 0) {
+    size = 1;
+  }
+  void* p = std::malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  if (p != nullptr) {
+    alloc_count_live.fetch_sub(1, std::memory_order_relaxed);
+    std::free(p);
+  }
+}
+
+void operator delete(void* p, std::size_t) noexcept { operator delete(p); }
+
+// operator new[] and the nothrow overloads forward to operator new by default,
+// and the array operator deletes forward to operator delete.
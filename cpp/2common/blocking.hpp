@@ -0,0 +1,96 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Runs blocking_task_count independent tasks that each do a fixed amount of
+// CPU work. Pct out of every 100 tasks first make a blocking call that sleeps
+// the calling thread. The "inplace" config makes the blocking call on the
+// worker thread. The "offload" config hands it to a separate set of
+// blocking_offload_threads threads, using the runtime's mechanism for that.
+inline constexpr size_t blocking_task_count = 100000;
+inline constexpr size_t blocking_cpu_units = 2000;
+inline constexpr std::chrono::microseconds blocking_call_duration{1000};
+inline constexpr size_t blocking_offload_threads = 64;
+
+static inline bool blocking_is_blocking(size_t Index, size_t Pct) {
+  return Index % 100 < Pct;
+}
+
+// A few microseconds of CPU work.
+static inline uint64_t blocking_cpu_work(size_t Index) {
+  uint64_t value = Index;
+  for (size_t i = 0; i < blocking_cpu_units; ++i) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return value;
+}
+
+// Stands in for a blocking syscall, such as a synchronous read.
+static inline void blocking_call() {
+  std::this_thread::sleep_for(blocking_call_duration);
+}
+
+static inline uint64_t blocking_expected_checksum() {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < blocking_task_count; ++i) {
+    sum += blocking_cpu_work(i);
+  }
+  return sum;
+}
+
+// A plain pool of threads for runtimes that don't provide a separate executor
+// for blocking work.
+class blocking_thread_pool {
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<std::function<void()>> queue;
+  std::vector<std::thread> threads;
+  bool stopping = false;
+
+public:
+  explicit blocking_thread_pool(size_t ThreadCount) {
+    for (size_t i = 0; i < ThreadCount; ++i) {
+      threads.emplace_back([this]() {
+        while (true) {
+          std::function<void()> fn;
+          {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+              return;
+            }
+            fn = std::move(queue.front());
+            queue.pop_front();
+          }
+          fn();
+        }
+      });
+    }
+  }
+
+  void submit(std::function<void()> Fn) {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      queue.push_back(std::move(Fn));
+    }
+    cv.notify_one();
+  }
+
+  ~blocking_thread_pool() {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stopping = true;
+    }
+    cv.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+};
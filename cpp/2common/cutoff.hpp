@@ -0,0 +1,77 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+
+// The grain size of the recursive benchmarks is set by the CUTOFF environment
+// variable, so that it can be swept without changing their command lines.
+// Below the cutoff, a task computes its whole subtree serially instead of
+// spawning children. What the cutoff counts depends on the benchmark, and the
+// defaults keep the finest grain:
+// - fib: fib(n) is computed serially for n < cutoff (default 2)
+// - skynet: the last cutoff levels above the leaves are summed serially
+//   (default 0)
+// - nqueens: the last cutoff rows are searched serially (default 0)
+// - matmul: tiles up to cutoff x cutoff are computed by the base case kernel
+//   (default 32, see matmul.hpp)
+static inline size_t cutoff_from_env(size_t Default, size_t Min = 0) {
+  const char* value = std::getenv("CUTOFF");
+  if (value == nullptr || *value == '\0') {
+    return Default;
+  }
+  size_t cutoff = static_cast<size_t>(std::strtoull(value, nullptr, 10));
+  return cutoff < Min ? Min : cutoff;
+}
+
+inline const size_t fib_cutoff = cutoff_from_env(2, 2);
+inline const size_t skynet_cutoff = cutoff_from_env(0);
+inline const size_t nqueens_cutoff = cutoff_from_env(0);
+
+static inline size_t fib_serial(size_t n) {
+  if (n < 2) {
+    return n;
+  }
+  return fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+// The sum of the 10^Levels leaf numbers starting at BaseNum, computed with the
+// same 10-way recursion as the parallel versions.
+static inline size_t skynet_serial(size_t BaseNum, size_t Levels) {
+  if (Levels == 0) {
+    return BaseNum;
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < Levels - 1; ++i) {
+    depthOffset *= 10;
+  }
+  size_t count = 0;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    count += skynet_serial(BaseNum + depthOffset * idx, Levels - 1);
+  }
+  return count;
+}
+
+// The number of solutions with the queens in buf[0:xMax] already placed.
+template <size_t N>
+static inline int nqueens_serial(int xMax, std::array<char, N> buf) {
+  if (xMax == static_cast<int>(N)) {
+    return 1;
+  }
+  int count = 0;
+  for (int y = 0; y < static_cast<int>(N); ++y) {
+    char q = static_cast<char>(y);
+    bool legal = true;
+    for (int x = 0; x < xMax; ++x) {
+      char p = buf[x];
+      if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+        legal = false;
+        break;
+      }
+    }
+    if (legal) {
+      buf[xMax] = q;
+      count += nqueens_serial(xMax + 1, buf);
+    }
+  }
+  return count;
+}
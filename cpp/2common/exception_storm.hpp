@@ -0,0 +1,107 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+// Runs exception_storm_rounds skynet-shaped trees of depth 6 (1M leaves).
+// Each leaf throws with probability Ppm / 1'000'000, chosen deterministically
+// from the round and leaf number. A round in which any leaf throws must
+// deliver an exception_storm_error to the root. Other rounds must return the
+// normal skynet sum.
+inline constexpr size_t exception_storm_depth = 6;
+inline constexpr size_t exception_storm_leaves = 1000000;
+inline constexpr size_t exception_storm_rounds = 100;
+inline constexpr size_t exception_storm_sum = 499999500000;
+
+struct exception_storm_error : std::exception {
+  size_t leaf;
+
+  explicit exception_storm_error(size_t Leaf) : leaf{Leaf} {}
+
+  const char* what() const noexcept override { return "exception_storm leaf"; }
+};
+
+static inline bool
+exception_storm_throws(size_t Round, size_t Leaf, size_t Ppm) {
+  if (Ppm == 0) {
+    return false;
+  }
+  uint64_t x = static_cast<uint64_t>(Round) * exception_storm_leaves + Leaf;
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return x % 1000000 < Ppm;
+}
+
+// The leaf task body.
+static inline size_t
+exception_storm_leaf(size_t Round, size_t Leaf, size_t Ppm) {
+  if (exception_storm_throws(Round, Leaf, Ppm)) {
+    throw exception_storm_error(Leaf);
+  }
+  return Leaf;
+}
+
+static inline bool exception_storm_round_fails(size_t Round, size_t Ppm) {
+  for (size_t leaf = 0; leaf < exception_storm_leaves; ++leaf) {
+    if (exception_storm_throws(Round, leaf, Ppm)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Tracks the time taken by succeeding and failing rounds separately, so that
+// the time to propagate an exception to the root can be compared with the
+// time to complete a whole tree. The expected outcome of each round is
+// computed up front, outside of the timed region.
+struct exception_storm_stats {
+  std::array<bool, exception_storm_rounds> should_throw;
+  size_t ok_rounds = 0;
+  size_t failed_rounds = 0;
+  size_t wrong_results = 0;
+  uint64_t ok_ns = 0;
+  uint64_t failed_ns = 0;
+
+  explicit exception_storm_stats(size_t Ppm) {
+    for (size_t round = 0; round < exception_storm_rounds; ++round) {
+      should_throw[round] = exception_storm_round_fails(round, Ppm);
+    }
+  }
+
+  void record(
+    size_t Round, bool Threw, size_t Result,
+    std::chrono::steady_clock::duration Elapsed
+  ) {
+    uint64_t ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Elapsed).count()
+    );
+    if (Threw) {
+      ++failed_rounds;
+      failed_ns += ns;
+      if (!should_throw[Round]) {
+        ++wrong_results;
+      }
+    } else {
+      ++ok_rounds;
+      ok_ns += ns;
+      if (should_throw[Round] || Result != exception_storm_sum) {
+        ++wrong_results;
+      }
+    }
+  }
+
+  size_t ok_round_us() const {
+    return ok_rounds == 0 ? 0 : static_cast<size_t>(ok_ns / ok_rounds / 1000);
+  }
+
+  size_t failed_round_us() const {
+    return failed_rounds == 0
+             ? 0
+             : static_cast<size_t>(failed_ns / failed_rounds / 1000);
+  }
+};
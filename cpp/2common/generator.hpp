@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// A source generator yields [0, generator_element_count) which is then passed
+// through a chain of nested generators. Even-numbered stages transform each
+// element and odd-numbered stages filter out a small fraction of elements.
+static constexpr size_t generator_element_count = 10000000;
+
+static inline uint64_t generator_transform(uint64_t value) {
+  return value * 3 + 1;
+}
+
+static inline bool generator_keep(uint64_t value) {
+  return value % 1024 != 1023;
+}
+
+struct generator_result {
+  size_t count;
+  uint64_t sum;
+
+  bool operator==(const generator_result&) const = default;
+};
+
+// Computes the expected output of a chain with the given depth without using
+// generators.
+static inline generator_result generator_expected(size_t depth) {
+  generator_result r{0, 0};
+  for (uint64_t i = 0; i < generator_element_count; ++i) {
+    uint64_t value = i;
+    bool keep = true;
+    for (size_t stage = 0; stage < depth && keep; ++stage) {
+      if (stage % 2 == 0) {
+        value = generator_transform(value);
+      } else {
+        keep = generator_keep(value);
+      }
+    }
+    if (keep) {
+      ++r.count;
+      r.sum += value;
+    }
+  }
+  return r;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Log2-bucketed latency histogram. Bucket 0 holds values below 1us, and
+// bucket N holds values in [2^(N-1), 2^N) us. Each thread should record into
+// its own histogram and merge them at the end.
+struct latency_histogram {
+  static constexpr size_t bucket_count = 24;
+  std::array<size_t, bucket_count> buckets{};
+  size_t count = 0;
+  uint64_t max_ns = 0;
+
+  void record(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    size_t bucket = static_cast<size_t>(std::bit_width(us));
+    if (bucket >= bucket_count) {
+      bucket = bucket_count - 1;
+    }
+    ++buckets[bucket];
+    ++count;
+    if (ns > max_ns) {
+      max_ns = ns;
+    }
+  }
+
+  void merge(const latency_histogram& other) {
+    for (size_t i = 0; i < bucket_count; ++i) {
+      buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    if (other.max_ns > max_ns) {
+      max_ns = other.max_ns;
+    }
+  }
+
+  // Returns the upper bound in microseconds of the bucket containing the
+  // given percentile (0-100), capped at the maximum recorded value.
+  size_t percentile_us(double percentile) const {
+    size_t max_us = static_cast<size_t>(max_ns / 1000);
+    size_t target = static_cast<size_t>(
+      percentile / 100.0 * static_cast<double>(count)
+    );
+    size_t seen = 0;
+    for (size_t i = 0; i < bucket_count; ++i) {
+      seen += buckets[i];
+      if (seen > target) {
+        size_t bound = size_t{1} << i;
+        return bound < max_us ? bound : max_us;
+      }
+    }
+    return max_us;
+  }
+
+  // Prints the non-empty buckets as a YAML map under the given key, indented
+  // to sit inside a `runs:` entry.
+  void print_yaml(const char* name) const {
+    std::printf("    %s:\n", name);
+    for (size_t i = 0; i < bucket_count; ++i) {
+      if (buckets[i] != 0) {
+        std::printf("      lt_%zu_us: %zu\n", size_t{1} << i, buckets[i]);
+      }
+    }
+  }
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include "histogram.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+// Each request starts on the CPU executor and moves to the I/O executor and
+// back hops/2 times, as a request that alternates between compute and I/O
+// would. hop_concurrency request loops run at once, each processing its share
+// of the requests one after another. The total number of hops is fixed, so the
+// request count is hop_total_hops / hops.
+// The I/O executor must run on a single thread, which is recorded in
+// hop_io_thread before the timed region so each hop can be checked.
+inline constexpr size_t hop_total_hops = 1000000;
+inline constexpr size_t hop_concurrency = 64;
+
+inline std::thread::id hop_io_thread;
+
+// Per-loop hop latencies, measured from just before the hop is requested to
+// when the request resumes on the other executor. Each request loop owns one
+// of these, so recording is single-writer.
+struct hop_stats {
+  using clock = std::chrono::steady_clock;
+
+  latency_histogram to_io;
+  latency_histogram to_cpu;
+  uint64_t total_ns = 0;
+  size_t misplaced = 0;
+
+  // Call right after arriving on the I/O executor.
+  void arrived_io(clock::time_point Start) {
+    record(to_io, Start);
+    if (std::this_thread::get_id() != hop_io_thread) {
+      ++misplaced;
+    }
+  }
+
+  // Call right after arriving back on the CPU executor.
+  void arrived_cpu(clock::time_point Start) {
+    record(to_cpu, Start);
+    if (std::this_thread::get_id() == hop_io_thread) {
+      ++misplaced;
+    }
+  }
+
+  void merge(const hop_stats& Other) {
+    to_io.merge(Other.to_io);
+    to_cpu.merge(Other.to_cpu);
+    total_ns += Other.total_ns;
+    misplaced += Other.misplaced;
+  }
+
+  // Prints the FAIL line (if any) and the metrics inside a `runs:` entry.
+  void print_yaml(size_t Hops, size_t TotalTimeUs) const {
+    size_t hops = to_io.count + to_cpu.count;
+    if (hops != hop_total_hops / Hops * Hops) {
+      std::printf(
+        "FAIL: expected %zu hops but got %zu\n", hop_total_hops / Hops * Hops,
+        hops
+      );
+    }
+    if (misplaced != 0) {
+      std::printf("FAIL: %zu hops resumed on the wrong executor\n", misplaced);
+    }
+    std::printf("    requests: %zu\n", hop_total_hops / Hops);
+    std::printf("    duration: %zu us\n", TotalTimeUs);
+    std::printf(
+      "    hops/sec: %zu\n",
+      static_cast<size_t>(hops * 1000000 / TotalTimeUs)
+    );
+    std::printf(
+      "    hop_mean_ns: %zu\n", static_cast<size_t>(total_ns / hops)
+    );
+    std::printf("    to_io_p50_us: %zu\n", to_io.percentile_us(50));
+    std::printf("    to_io_p99_us: %zu\n", to_io.percentile_us(99));
+    std::printf("    to_cpu_p50_us: %zu\n", to_cpu.percentile_us(50));
+    std::printf("    to_cpu_p99_us: %zu\n", to_cpu.percentile_us(99));
+  }
+
+private:
+  void record(latency_histogram& Histogram, clock::time_point Start) {
+    auto ns = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        clock::now() - Start
+      )
+        .count()
+    );
+    Histogram.record(ns);
+    total_ns += ns;
+  }
+};
+
+// Splits the requests across the request loops.
+static inline size_t hop_requests_for_loop(size_t Loop, size_t Hops) {
+  size_t requests = hop_total_hops / Hops;
+  return requests / hop_concurrency +
+         (Loop < requests % hop_concurrency ? 1 : 0);
+}
@@ -1,11 +1,542 @@
 #pragma once
+#include "cutoff.hpp"
 
-static inline void matmul_small(int* a, int* b, int* c, int n, int N) {
-  for (int i = 0; i < n; i++) {
-    for (int k = 0; k < n; k++) {
-      for (int j = 0; j < n; j++) {
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+// The recursive matmul multiplies two row-major N x N matrices. Each level
+// splits the rows, depth and columns of a tile in half, rounding down for the
+// first half, so N doesn't need to be a power of two and the halves may be
+// uneven. Tiles are therefore rectangular: C[0:rows, 0:cols] +=
+// A[0:rows, 0:depth] * B[0:depth, 0:cols], with each pointer at the top-left
+// corner of its part of the N x N matrix.
+template <typename T> struct matmul_tile {
+  T* a;
+  T* b;
+  T* c;
+  int rows;
+  int depth;
+  int cols;
+};
+
+// Tiles that fit in matmul_cutoff x matmul_cutoff are computed by
+// matmul_small.
+inline const int matmul_cutoff = static_cast<int>(cutoff_from_env(32, 1));
+
+template <typename T>
+static inline bool matmul_is_leaf(const matmul_tile<T>& Tile) {
+  return Tile.rows <= matmul_cutoff && Tile.depth <= matmul_cutoff &&
+         Tile.cols <= matmul_cutoff;
+}
+
+// Splits Tile into 8 subtiles. The first 4 multiply by the first half of the
+// depth and the last 4 by the second half. Within each group of 4 the subtiles
+// write to disjoint parts of C, so they can run in parallel, but the groups
+// must run one after the other.
+template <typename T>
+static inline std::array<matmul_tile<T>, 8>
+matmul_split(const matmul_tile<T>& Tile, int N) {
+  int r = Tile.rows / 2;
+  int d = Tile.depth / 2;
+  int c = Tile.cols / 2;
+  int r2 = Tile.rows - r;
+  int d2 = Tile.depth - d;
+  int c2 = Tile.cols - c;
+  T* a = Tile.a;
+  T* b = Tile.b;
+  T* o = Tile.c;
+  return {{
+    {a, b, o, r, d, c},
+    {a, b + c, o + c, r, d, c2},
+    {a + r * N, b, o + r * N, r2, d, c},
+    {a + r * N, b + c, o + r * N + c, r2, d, c2},
+    {a + d, b + d * N, o, r, d2, c},
+    {a + d, b + d * N + c, o + c, r, d2, c2},
+    {a + r * N + d, b + d * N, o + r * N, r2, d2, c},
+    {a + r * N + d, b + d * N + c, o + r * N + c, r2, d2, c2},
+  }};
+}
+
+// Base case kernels for the recursive matmul. The naive kernel is the default.
+// The faster kernels shrink the time spent in the base case, so that
+// scheduling overhead becomes a larger share of the total. Call
+// matmul_select_kernel() before running.
+enum class matmul_kernel { NAIVE, BLOCKED, SIMD };
+
+inline matmul_kernel matmul_kernel_choice = matmul_kernel::NAIVE;
+
+// Selects the kernel named by a benchmark config: "naive", "blocked", or
+// "simd". Returns false if Name isn't one of these.
+static inline bool matmul_select_kernel(const char* Name) {
+  if (std::strcmp(Name, "naive") == 0) {
+    matmul_kernel_choice = matmul_kernel::NAIVE;
+  } else if (std::strcmp(Name, "blocked") == 0) {
+    matmul_kernel_choice = matmul_kernel::BLOCKED;
+  } else if (std::strcmp(Name, "simd") == 0) {
+    matmul_kernel_choice = matmul_kernel::SIMD;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+static inline void matmul_small_naive(
+  const T* a, const T* b, T* c, int rows, int depth, int cols, int N
+) {
+  for (int i = 0; i < rows; i++) {
+    for (int k = 0; k < depth; k++) {
+      for (int j = 0; j < cols; j++) {
         c[i * N + j] += a[i * N + k] * b[k * N + j];
       }
     }
   }
-}
\ No newline at end of file
+}
+
+// Copies the depth x cols tile of B into a contiguous per-thread buffer, with
+// each row padded with zeros to a multiple of Align columns. Tiles are often a
+// column short of a whole block when N isn't a power of two, and the padding
+// lets the kernels compute the last block at full width instead of separately.
+template <typename T>
+static inline T*
+matmul_pack(const T* b, int depth, int cols, int Align, int N, int& Stride) {
+  Stride = (cols + Align - 1) / Align * Align;
+  thread_local std::vector<T> packed;
+  size_t size = static_cast<size_t>(depth) * static_cast<size_t>(Stride);
+  if (packed.size() < size) {
+    packed.resize(size);
+  }
+  T* p = packed.data();
+  for (int k = 0; k < depth; k++) {
+    std::memcpy(
+      p + k * Stride, b + k * N, sizeof(T) * static_cast<size_t>(cols)
+    );
+    for (int x = cols; x < Stride; x++) {
+      p[k * Stride + x] = T{};
+    }
+  }
+  return p;
+}
+
+// Computes R rows of C starting at row I, 32 columns at a time, from the
+// packed B tile P. Each R x 32 block of C is accumulated in a local array
+// across the whole k loop, so that it can stay in registers. The fixed-size
+// inner loops are left for the compiler to vectorize.
+template <typename T, int R>
+static inline void matmul_block_rows(
+  const T* a, const T* P, T* c, int I, int depth, int cols, int Stride, int N
+) {
+  constexpr int W = 32;
+  for (int j = 0; j < cols; j += W) {
+    T acc[R][W] = {};
+    for (int k = 0; k < depth; k++) {
+      for (int r = 0; r < R; r++) {
+        T ar = a[(I + r) * N + k];
+        for (int x = 0; x < W; x++) {
+          acc[r][x] += ar * P[k * Stride + j + x];
+        }
+      }
+    }
+    int width = cols - j < W ? cols - j : W;
+    for (int r = 0; r < R; r++) {
+      for (int x = 0; x < width; x++) {
+        c[(I + r) * N + j + x] += acc[r][x];
+      }
+    }
+  }
+}
+
+template <typename T>
+static inline void matmul_small_blocked(
+  const T* a, const T* b, T* c, int rows, int depth, int cols, int N
+) {
+  int stride;
+  const T* p = matmul_pack(b, depth, cols, 32, N, stride);
+  int i = 0;
+  for (; i + 4 <= rows; i += 4) {
+    matmul_block_rows<T, 4>(a, p, c, i, depth, cols, stride, N);
+  }
+  for (; i < rows; i++) {
+    matmul_block_rows<T, 1>(a, p, c, i, depth, cols, stride, N);
+  }
+}
+
+// Vector operations for the SIMD kernel. Types without a specialization fall
+// back to the blocked kernel.
+template <typename T> struct matmul_vec;
+
+#if defined(__AVX512F__)
+template <> struct matmul_vec<float> {
+  static constexpr int width = 16;
+  using reg = __m512;
+  static reg zero() { return _mm512_setzero_ps(); }
+  static reg load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, reg v) { _mm512_storeu_ps(p, v); }
+  static reg set1(float x) { return _mm512_set1_ps(x); }
+  static reg add(reg x, reg y) { return _mm512_add_ps(x, y); }
+  static reg madd(reg acc, reg x, reg y) { return _mm512_fmadd_ps(x, y, acc); }
+};
+template <> struct matmul_vec<double> {
+  static constexpr int width = 8;
+  using reg = __m512d;
+  static reg zero() { return _mm512_setzero_pd(); }
+  static reg load(const double* p) { return _mm512_loadu_pd(p); }
+  static void store(double* p, reg v) { _mm512_storeu_pd(p, v); }
+  static reg set1(double x) { return _mm512_set1_pd(x); }
+  static reg add(reg x, reg y) { return _mm512_add_pd(x, y); }
+  static reg madd(reg acc, reg x, reg y) { return _mm512_fmadd_pd(x, y, acc); }
+};
+template <> struct matmul_vec<int32_t> {
+  static constexpr int width = 16;
+  using reg = __m512i;
+  static reg zero() { return _mm512_setzero_si512(); }
+  static reg load(const int32_t* p) { return _mm512_loadu_si512(p); }
+  static void store(int32_t* p, reg v) { _mm512_storeu_si512(p, v); }
+  static reg set1(int32_t x) { return _mm512_set1_epi32(x); }
+  static reg add(reg x, reg y) { return _mm512_add_epi32(x, y); }
+  static reg madd(reg acc, reg x, reg y) {
+    return _mm512_add_epi32(acc, _mm512_mullo_epi32(x, y));
+  }
+};
+#elif defined(__AVX2__)
+template <> struct matmul_vec<float> {
+  static constexpr int width = 8;
+  using reg = __m256;
+  static reg zero() { return _mm256_setzero_ps(); }
+  static reg load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, reg v) { _mm256_storeu_ps(p, v); }
+  static reg set1(float x) { return _mm256_set1_ps(x); }
+  static reg add(reg x, reg y) { return _mm256_add_ps(x, y); }
+  static reg madd(reg acc, reg x, reg y) {
+#ifdef __FMA__
+    return _mm256_fmadd_ps(x, y, acc);
+#else
+    return _mm256_add_ps(acc, _mm256_mul_ps(x, y));
+#endif
+  }
+};
+template <> struct matmul_vec<double> {
+  static constexpr int width = 4;
+  using reg = __m256d;
+  static reg zero() { return _mm256_setzero_pd(); }
+  static reg load(const double* p) { return _mm256_loadu_pd(p); }
+  static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+  static reg set1(double x) { return _mm256_set1_pd(x); }
+  static reg add(reg x, reg y) { return _mm256_add_pd(x, y); }
+  static reg madd(reg acc, reg x, reg y) {
+#ifdef __FMA__
+    return _mm256_fmadd_pd(x, y, acc);
+#else
+    return _mm256_add_pd(acc, _mm256_mul_pd(x, y));
+#endif
+  }
+};
+template <> struct matmul_vec<int32_t> {
+  static constexpr int width = 8;
+  using reg = __m256i;
+  static reg zero() { return _mm256_setzero_si256(); }
+  static reg load(const int32_t* p) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+  }
+  static void store(int32_t* p, reg v) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+  }
+  static reg set1(int32_t x) { return _mm256_set1_epi32(x); }
+  static reg add(reg x, reg y) { return _mm256_add_epi32(x, y); }
+  static reg madd(reg acc, reg x, reg y) {
+    return _mm256_add_epi32(acc, _mm256_mullo_epi32(x, y));
+  }
+};
+#endif
+
+template <typename T>
+concept matmul_has_vec = requires { matmul_vec<T>::width; };
+
+// Adds R rows of vector registers to C at row I and column J, writing only
+// the first Width columns.
+template <typename V, typename T, int R>
+static inline void matmul_store_rows(
+  T* c, const typename V::reg (&Acc)[R], int I, int J, int Width, int N
+) {
+  for (int r = 0; r < R; r++) {
+    T* ci = c + (I + r) * N + J;
+    if (Width == V::width) {
+      V::store(ci, V::add(V::load(ci), Acc[r]));
+    } else {
+      T part[V::width];
+      V::store(part, Acc[r]);
+      for (int x = 0; x < Width; x++) {
+        ci[x] += part[x];
+      }
+    }
+  }
+}
+
+// Computes R rows of C starting at row I, one vector width at a time, from
+// the packed B tile P whose rows are Stride elements apart.
+template <typename V, typename T, int R>
+static inline void matmul_vec_rows(
+  const T* a, const T* P, T* c, int I, int depth, int cols, int Stride, int N
+) {
+  constexpr int W = V::width;
+  for (int j = 0; j < cols; j += W) {
+    typename V::reg acc[R];
+    for (int r = 0; r < R; r++) {
+      acc[r] = V::zero();
+    }
+    for (int k = 0; k < depth; k++) {
+      typename V::reg bk = V::load(P + k * Stride + j);
+      for (int r = 0; r < R; r++) {
+        acc[r] = V::madd(acc[r], V::set1(a[(I + r) * N + k]), bk);
+      }
+    }
+    matmul_store_rows<V, T, R>(c, acc, I, j, cols - j < W ? cols - j : W, N);
+  }
+}
+
+// Packs the B tile, padded to a whole number of vectors, then computes 4 rows
+// by one vector width of C at a time in vector registers.
+template <typename T>
+static inline void matmul_small_simd(
+  const T* a, const T* b, T* c, int rows, int depth, int cols, int N
+) {
+  if constexpr (matmul_has_vec<T>) {
+    using V = matmul_vec<T>;
+    int stride;
+    const T* p = matmul_pack(b, depth, cols, V::width, N, stride);
+    int i = 0;
+    for (; i + 4 <= rows; i += 4) {
+      matmul_vec_rows<V, T, 4>(a, p, c, i, depth, cols, stride, N);
+    }
+    for (; i < rows; i++) {
+      matmul_vec_rows<V, T, 1>(a, p, c, i, depth, cols, stride, N);
+    }
+  } else {
+    matmul_small_blocked(a, b, c, rows, depth, cols, N);
+  }
+}
+
+template <typename T>
+static inline void matmul_small(const matmul_tile<T>& Tile, int N) {
+  switch (matmul_kernel_choice) {
+  case matmul_kernel::BLOCKED:
+    matmul_small_blocked(
+      Tile.a, Tile.b, Tile.c, Tile.rows, Tile.depth, Tile.cols, N
+    );
+    break;
+  case matmul_kernel::SIMD:
+    matmul_small_simd(
+      Tile.a, Tile.b, Tile.c, Tile.rows, Tile.depth, Tile.cols, N
+    );
+    break;
+  default:
+    matmul_small_naive(
+      Tile.a, Tile.b, Tile.c, Tile.rows, Tile.depth, Tile.cols, N
+    );
+    break;
+  }
+}
+
+// An upper bound on the number of matmul_small calls made by the recursive
+// matmul for N.
+static inline size_t matmul_leaf_count(int N) {
+  size_t parts = 1;
+  for (int n = N; n > matmul_cutoff; n = (n + 1) / 2) {
+    parts *= 2;
+  }
+  return parts * parts * parts;
+}
+
+// The inputs are pseudo-random, but each element is a pure function of its
+// position, so that tiles can be initialized in any order on any thread.
+// Elements are integers in [-8, 8], or multiples of 1/8 in [-1, 1] for
+// floating point types. Then every product and partial sum is exactly
+// representable (in float, for N up to 2^18), so results don't depend on the
+// order of the additions and can be checked exactly.
+static inline uint64_t matmul_hash(uint64_t X) {
+  X += 0x9e3779b97f4a7c15;
+  X = (X ^ (X >> 30)) * 0xbf58476d1ce4e5b9;
+  X = (X ^ (X >> 27)) * 0x94d049bb133111eb;
+  return X ^ (X >> 31);
+}
+
+template <typename T>
+static inline T matmul_input(uint64_t Seed, size_t Index) {
+  int v = static_cast<int>(matmul_hash((Seed << 40) + Index) % 17) - 8;
+  if constexpr (std::is_floating_point_v<T>) {
+    return static_cast<T>(v) / 8;
+  } else {
+    return static_cast<T>(v);
+  }
+}
+
+// Owns the three N x N matrices. The memory is default-initialized, so the
+// pages aren't touched until they're written by init().
+template <typename T> struct matmul_matrices {
+  int N;
+  std::unique_ptr<T[]> a;
+  std::unique_ptr<T[]> b;
+  std::unique_ptr<T[]> c;
+
+  explicit matmul_matrices(int Size)
+      : N(Size), a(new T[elements()]), b(new T[elements()]),
+        c(new T[elements()]) {}
+
+  size_t elements() const {
+    return static_cast<size_t>(N) * static_cast<size_t>(N);
+  }
+
+  matmul_tile<T> tile() const { return {a.get(), b.get(), c.get(), N, N, N}; }
+
+  // Initializes the elements of all three matrices that are at the positions
+  // of Tile's output: the inputs to their random values, and the output to 0.
+  // The tiles of a recursive split of tile() can be initialized in parallel.
+  void init(const matmul_tile<T>& Tile) {
+    size_t origin = static_cast<size_t>(Tile.c - c.get());
+    for (size_t i = 0; i < static_cast<size_t>(Tile.rows); i++) {
+      for (size_t j = 0; j < static_cast<size_t>(Tile.cols); j++) {
+        size_t idx = origin + i * static_cast<size_t>(N) + j;
+        a[idx] = matmul_input<T>(0, idx);
+        b[idx] = matmul_input<T>(1, idx);
+        c[idx] = T{};
+      }
+    }
+  }
+
+  void init() { init(tile()); }
+
+  // Checks C == A * B with Freivalds' algorithm: for a random vector r,
+  // A * (B * r) must equal C * r. Each round costs O(N^2) instead of the
+  // O(N^3) of a reference multiplication, and misses a wrong result with
+  // probability at most 1/17.
+  void validate() const {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // Wide enough to hold the sums exactly
+    using acc_t = std::conditional_t<
+      std::is_floating_point_v<T>, long double, int64_t>;
+    size_t n = static_cast<size_t>(N);
+    std::vector<acc_t> r(n);
+    std::vector<acc_t> br(n);
+    for (uint64_t round = 0; round < 3; round++) {
+      for (size_t j = 0; j < n; j++) {
+        r[j] = matmul_input<acc_t>(2 + round, j);
+      }
+      for (size_t k = 0; k < n; k++) {
+        acc_t sum{};
+        for (size_t j = 0; j < n; j++) {
+          sum += static_cast<acc_t>(b[k * n + j]) * r[j];
+        }
+        br[k] = sum;
+      }
+      for (size_t i = 0; i < n; i++) {
+        acc_t expected{};
+        acc_t actual{};
+        for (size_t k = 0; k < n; k++) {
+          expected += static_cast<acc_t>(a[i * n + k]) * br[k];
+          actual += static_cast<acc_t>(c[i * n + k]) * r[k];
+        }
+        if (actual != expected) {
+          std::printf(
+            "Wrong result in row %zu : %Lg. expected %Lg\n", i,
+            static_cast<long double>(actual),
+            static_cast<long double>(expected)
+          );
+          std::fflush(stdout);
+          std::terminate();
+        }
+      }
+    }
+  }
+};
+
+// Element types selectable by the benchmark config.
+enum class matmul_type { INT, INT64, FLOAT, DOUBLE };
+
+// Selects the type named by a benchmark config: "int", "int64", "float", or
+// "double". Returns false if Name isn't one of these.
+static inline bool matmul_select_type(const char* Name, matmul_type& Type) {
+  if (std::strcmp(Name, "int") == 0) {
+    Type = matmul_type::INT;
+  } else if (std::strcmp(Name, "int64") == 0) {
+    Type = matmul_type::INT64;
+  } else if (std::strcmp(Name, "float") == 0) {
+    Type = matmul_type::FLOAT;
+  } else if (std::strcmp(Name, "double") == 0) {
+    Type = matmul_type::DOUBLE;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Calls Fn.template operator()<T>() with the element type for Type.
+template <typename Fn>
+static inline void matmul_with_type(matmul_type Type, Fn&& F) {
+  switch (Type) {
+  case matmul_type::INT64:
+    F.template operator()<int64_t>();
+    break;
+  case matmul_type::FLOAT:
+    F.template operator()<float>();
+    break;
+  case matmul_type::DOUBLE:
+    F.template operator()<double>();
+    break;
+  default:
+    F.template operator()<int32_t>();
+    break;
+  }
+}
+
+struct matmul_args {
+  int n = 0;
+  matmul_type type = matmul_type::INT;
+  bool first_touch = false;
+};
+
+// Parses `matmul <matrix size> [threads] [config]`. The config is a
+// '-'-separated list of a kernel name, an element type, and "firsttouch" (only
+// supported by some runtimes), in any order, e.g. "float-simd". Selects the
+// kernel as a side effect.
+static inline matmul_args matmul_parse_args(int argc, char* argv[]) {
+  matmul_args args;
+  args.n = atoi(argv[1]);
+  if (args.n < 1) {
+    std::printf("Invalid matrix size: %s\n", argv[1]);
+    exit(1);
+  }
+  if (argc > 3) {
+    std::string config = argv[3];
+    size_t pos = 0;
+    while (pos <= config.size()) {
+      size_t end = config.find('-', pos);
+      if (end == std::string::npos) {
+        end = config.size();
+      }
+      std::string part = config.substr(pos, end - pos);
+      if (part == "firsttouch") {
+        args.first_touch = true;
+      } else if (!part.empty() && !matmul_select_kernel(part.c_str()) &&
+                 !matmul_select_type(part.c_str(), args.type)) {
+        std::printf("Unknown matmul config: %s\n", part.c_str());
+        exit(1);
+      }
+      pos = end + 1;
+    }
+  }
+  return args;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Find-first variant of nqueens. Instead of counting every solution, the
+// search stops as soon as it finds a solution whose board hash satisfies
+// nqueens_first_match. Exactly one solution of the 14-queens problem matches,
+// and a serial depth-first search reaches it about 45% of the way through the
+// tree. So a parallel search must explore much of the tree before it can
+// cancel the remaining work.
+inline constexpr int nqueens_first_work = 14;
+inline constexpr uint64_t nqueens_first_answer = 16835042607841411072ULL;
+
+// FNV-1a hash of the queen positions.
+template <size_t N>
+static inline uint64_t nqueens_first_hash(const std::array<char, N>& Buf) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : Buf) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static inline bool nqueens_first_match(uint64_t Hash) {
+  return Hash % 262144 == 0;
+}
+
+// Shared by all tasks of one search. Tasks should poll found() before
+// spawning children and return early once it is set.
+struct nqueens_first_state {
+  std::atomic<bool> done{false};
+  uint64_t answer = 0;
+  std::chrono::steady_clock::time_point found_at;
+
+  bool found() const { return done.load(std::memory_order_relaxed); }
+
+  // Returns true if this call published the answer, or false if another task
+  // already did.
+  bool publish(uint64_t Hash) {
+    bool expected = false;
+    if (!done.compare_exchange_strong(
+          expected, true, std::memory_order_acq_rel
+        )) {
+      return false;
+    }
+    answer = Hash;
+    found_at = std::chrono::steady_clock::now();
+    return true;
+  }
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <sched.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#ifdef NUMA_USE_HWLOC
+#include <hwloc.h>
+#endif
+
+// Records the CPU that ran each leaf task and the address that it wrote.
+// After the run, both are mapped to NUMA nodes with hwloc, to report how many
+// leaves wrote memory that is local to the node they ran on. Without hwloc
+// (NUMA_USE_HWLOC not defined), nothing is reported.
+class numa_leaf_log {
+  std::vector<std::pair<const void*, int>> leaves;
+  std::atomic<size_t> count{0};
+
+public:
+  explicit numa_leaf_log(size_t MaxLeaves) : leaves(MaxLeaves) {}
+
+  void record(const void* Output) {
+    size_t i = count.fetch_add(1, std::memory_order_relaxed);
+    if (i < leaves.size()) {
+      leaves[i] = {Output, sched_getcpu()};
+    }
+  }
+
+  // Prints the locality of the leaves that wrote into [Base, Base + Bytes) as
+  // metrics inside a `runs:` entry, along with the node of each of its pages.
+  void print_yaml(
+    [[maybe_unused]] const void* Base, [[maybe_unused]] size_t Bytes
+  ) const {
+#ifdef NUMA_USE_HWLOC
+    hwloc_topology_t topo;
+    hwloc_topology_init(&topo);
+    hwloc_topology_load(topo);
+
+    // OS index of the node of each CPU
+    std::vector<int> cpuNode;
+    int nodeCount = hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_NUMANODE);
+    for (int i = 0; i < nodeCount; ++i) {
+      hwloc_obj_t node = hwloc_get_obj_by_type(topo, HWLOC_OBJ_NUMANODE, i);
+      int cpu;
+      hwloc_bitmap_foreach_begin(cpu, node->cpuset) {
+        if (static_cast<size_t>(cpu) >= cpuNode.size()) {
+          cpuNode.resize(static_cast<size_t>(cpu) + 1, -1);
+        }
+        cpuNode[static_cast<size_t>(cpu)] = static_cast<int>(node->os_index);
+      }
+      hwloc_bitmap_foreach_end();
+    }
+
+    // OS index of the node of each page, or -1 if it isn't resident
+    uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(Base) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(Base) + Bytes;
+    std::vector<int> pageNode((end - start + pageSize - 1) / pageSize, -1);
+    std::vector<size_t> nodePages;
+    hwloc_nodeset_t nodeset = hwloc_bitmap_alloc();
+    for (size_t i = 0; i < pageNode.size(); ++i) {
+      void* page = reinterpret_cast<void*>(start + i * pageSize);
+      if (hwloc_get_area_memlocation(
+            topo, page, 1, nodeset, HWLOC_MEMBIND_BYNODESET
+          ) == 0 &&
+          !hwloc_bitmap_iszero(nodeset)) {
+        int node = hwloc_bitmap_first(nodeset);
+        pageNode[i] = node;
+        if (static_cast<size_t>(node) >= nodePages.size()) {
+          nodePages.resize(static_cast<size_t>(node) + 1, 0);
+        }
+        ++nodePages[static_cast<size_t>(node)];
+      }
+    }
+    hwloc_bitmap_free(nodeset);
+    hwloc_topology_destroy(topo);
+
+    size_t local = 0;
+    size_t remote = 0;
+    size_t unknown = 0;
+    size_t recorded = count.load();
+    if (recorded > leaves.size()) {
+      recorded = leaves.size();
+    }
+    for (size_t i = 0; i < recorded; ++i) {
+      auto [output, cpu] = leaves[i];
+      uintptr_t addr = reinterpret_cast<uintptr_t>(output);
+      int memNode = -1;
+      if (addr >= start && addr < end) {
+        memNode = pageNode[(addr - start) / pageSize];
+      }
+      int cpuNodeIdx = -1;
+      if (cpu >= 0 && static_cast<size_t>(cpu) < cpuNode.size()) {
+        cpuNodeIdx = cpuNode[static_cast<size_t>(cpu)];
+      }
+      if (memNode < 0 || cpuNodeIdx < 0) {
+        ++unknown;
+      } else if (memNode == cpuNodeIdx) {
+        ++local;
+      } else {
+        ++remote;
+      }
+    }
+
+    std::printf("    numa_nodes: %d\n", nodeCount);
+    std::printf("    leaves_local: %zu\n", local);
+    std::printf("    leaves_remote: %zu\n", remote);
+    if (unknown != 0) {
+      std::printf("    leaves_unknown: %zu\n", unknown);
+    }
+    if (local + remote != 0) {
+      std::printf("    local_pct: %zu\n", local * 100 / (local + remote));
+    }
+    for (size_t i = 0; i < nodePages.size(); ++i) {
+      if (nodePages[i] != 0) {
+        std::printf("    pages_on_node_%zu: %zu\n", i, nodePages[i]);
+      }
+    }
+#endif
+  }
+};
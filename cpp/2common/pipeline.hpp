@@ -0,0 +1,91 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A stream of items passes through a fixed sequence of CPU-bound stages.
+// The first stage (source) and the last stage (sink) are serial in every
+// implementation; the stages between them may process items in parallel.
+static constexpr size_t pipeline_item_count = 200000;
+
+// Cost of each stage, in iterations of pipeline_stage_work. The serial source
+// and sink are cheap so that they don't become the bottleneck too early.
+static constexpr std::array<size_t, 6> pipeline_stage_costs = {
+  50, 400, 1600, 800, 400, 50
+};
+static constexpr size_t pipeline_stage_count = pipeline_stage_costs.size();
+
+// Maximum number of items in flight at once.
+static inline size_t pipeline_token_count(size_t thread_count) {
+  return thread_count * 4;
+}
+
+struct pipeline_item {
+  size_t index;
+  uint64_t value;
+  std::chrono::steady_clock::time_point start;
+};
+
+static inline uint64_t pipeline_stage_work(uint64_t value, size_t stage) {
+  for (size_t i = 0; i < pipeline_stage_costs[stage]; ++i) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return value;
+}
+
+// Runs the source stage for one item.
+static inline pipeline_item pipeline_make_item(size_t index) {
+  auto start = std::chrono::steady_clock::now();
+  return pipeline_item{index, pipeline_stage_work(index, 0), start};
+}
+
+static inline uint64_t pipeline_expected_checksum() {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < pipeline_item_count; ++i) {
+    uint64_t value = i;
+    for (size_t stage = 0; stage < pipeline_stage_count; ++stage) {
+      value = pipeline_stage_work(value, stage);
+    }
+    sum += value;
+  }
+  return sum;
+}
+
+// Accumulated by the sink stage. Since the sink is serial, this doesn't need
+// to be synchronized.
+struct pipeline_stats {
+  size_t count = 0;
+  uint64_t checksum = 0;
+  std::vector<uint64_t> latency_ns;
+
+  pipeline_stats() { latency_ns.reserve(pipeline_item_count); }
+
+  // Runs the sink stage for one item.
+  void record(pipeline_item& item) {
+    item.value = pipeline_stage_work(item.value, pipeline_stage_count - 1);
+    auto end = std::chrono::steady_clock::now();
+    latency_ns.push_back(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - item.start)
+        .count()
+    ));
+    checksum += item.value;
+    ++count;
+  }
+
+  // Returns the latency at the given percentile (0-100) in microseconds.
+  size_t latency_us(double percentile) {
+    if (latency_ns.empty()) {
+      return 0;
+    }
+    size_t idx = static_cast<size_t>(
+      percentile / 100.0 * static_cast<double>(latency_ns.size() - 1)
+    );
+    std::nth_element(
+      latency_ns.begin(), latency_ns.begin() + idx, latency_ns.end()
+    );
+    return latency_ns[idx] / 1000;
+  }
+};
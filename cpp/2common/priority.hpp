@@ -0,0 +1,74 @@
+#pragma once
+#include "histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <latch>
+#include <thread>
+#include <vector>
+
+// A background load of repeated skynet trees saturates the executor while an
+// external thread injects latency-sensitive probe tasks at a fixed rate.
+// Probe latency is the time from posting the probe to it starting to run.
+inline constexpr size_t priority_probe_count = 10000;
+inline constexpr std::chrono::microseconds priority_probe_interval{100};
+inline constexpr size_t priority_background_depth = 6;
+inline constexpr size_t priority_background_sum = 499999500000;
+
+// Shared with the background load, which should check stop between trees and
+// increment trees after each one.
+struct priority_background {
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> trees{0};
+  std::atomic<size_t> wrong_results{0};
+
+  void record(size_t Result) {
+    if (Result != priority_background_sum) {
+      wrong_results.fetch_add(1, std::memory_order_relaxed);
+    }
+    trees.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+struct priority_probes {
+  std::vector<std::chrono::steady_clock::time_point> posted;
+  std::vector<uint64_t> latency_ns;
+  std::latch done;
+
+  priority_probes()
+      : posted(priority_probe_count), latency_ns(priority_probe_count),
+        done(priority_probe_count) {}
+
+  // Call at the start of probe Index.
+  void record(size_t Index) {
+    auto now = std::chrono::steady_clock::now();
+    latency_ns[Index] = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - posted[Index])
+        .count()
+    );
+    done.count_down();
+  }
+
+  // Posts the probes from the calling thread at a fixed rate, calling
+  // Post(Index) for each one. Returns after all of them have run.
+  template <typename Fn> void run(Fn&& Post) {
+    auto next = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < priority_probe_count; ++i) {
+      std::this_thread::sleep_until(next);
+      posted[i] = std::chrono::steady_clock::now();
+      Post(i);
+      next += priority_probe_interval;
+    }
+    done.wait();
+  }
+
+  latency_histogram histogram() const {
+    latency_histogram h;
+    for (uint64_t ns : latency_ns) {
+      h.record(ns);
+    }
+    return h;
+  }
+};
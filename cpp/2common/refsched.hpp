@@ -0,0 +1,707 @@
+#pragma once
+#include <atomic>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "trace.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+// A small work-stealing scheduler for fork-join tasks, used as a controlled
+// baseline. Each of its design choices can be changed on its own from the
+// benchmark config, so that a difference between two runtimes can be
+// attributed to a specific mechanism:
+// - deque: "chaselev" (default) is the lock-free Chase-Lev deque, "locked" is
+//   a std::deque behind a mutex
+// - victim selection: "random" (default) picks a random worker, "roundrobin"
+//   tries the worker after the one tried last, and "sticky" tries the last
+//   worker that it stole from first, then random ones
+// - idle strategy: "park" (default) spins briefly and then sleeps until work
+//   is pushed, "spin" never sleeps, and "yield" yields the CPU between
+//   attempts
+// - task type: "func" (default) runs lambdas in a task group, whose wait()
+//   runs other tasks until the group's tasks have completed, and "coro" runs
+//   coroutines, which suspend at the join and are resumed by their last child
+// The choices are runtime switches rather than template parameters so that
+// each benchmark is a single executable; the cost is a well-predicted branch
+// per deque operation.
+enum class refsched_deque { CHASE_LEV, LOCKED };
+enum class refsched_victim { RANDOM, ROUND_ROBIN, STICKY };
+enum class refsched_idle { PARK, SPIN, YIELD };
+enum class refsched_task { FUNC, CORO };
+
+struct refsched_options {
+  refsched_deque deque = refsched_deque::CHASE_LEV;
+  refsched_victim victim = refsched_victim::RANDOM;
+  refsched_idle idle = refsched_idle::PARK;
+  refsched_task task = refsched_task::FUNC;
+};
+
+// Sets the choice named Part in Opts. Returns false if Part isn't the name of
+// a choice.
+static inline bool
+refsched_select(const std::string& Part, refsched_options& Opts) {
+  if (Part == "chaselev") {
+    Opts.deque = refsched_deque::CHASE_LEV;
+  } else if (Part == "locked") {
+    Opts.deque = refsched_deque::LOCKED;
+  } else if (Part == "random") {
+    Opts.victim = refsched_victim::RANDOM;
+  } else if (Part == "roundrobin") {
+    Opts.victim = refsched_victim::ROUND_ROBIN;
+  } else if (Part == "sticky") {
+    Opts.victim = refsched_victim::STICKY;
+  } else if (Part == "park") {
+    Opts.idle = refsched_idle::PARK;
+  } else if (Part == "spin") {
+    Opts.idle = refsched_idle::SPIN;
+  } else if (Part == "yield") {
+    Opts.idle = refsched_idle::YIELD;
+  } else if (Part == "func") {
+    Opts.task = refsched_task::FUNC;
+  } else if (Part == "coro") {
+    Opts.task = refsched_task::CORO;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Parses the choices out of the '-'-separated config in argv[ConfigArg], e.g.
+// "locked-sticky". If Strict is false, the other parts are left in
+// argv[ConfigArg] for the benchmark to parse; otherwise they are an error.
+static inline refsched_options refsched_parse_config(
+  int argc, char* argv[], int ConfigArg, bool Strict = true
+) {
+  refsched_options opts;
+  if (argc <= ConfigArg) {
+    return opts;
+  }
+  static std::string rest;
+  std::string config = argv[ConfigArg];
+  size_t pos = 0;
+  while (pos <= config.size()) {
+    size_t end = config.find('-', pos);
+    if (end == std::string::npos) {
+      end = config.size();
+    }
+    std::string part = config.substr(pos, end - pos);
+    if (!part.empty() && !refsched_select(part, opts)) {
+      if (Strict) {
+        std::printf("Unknown refsched config: %s\n", part.c_str());
+        exit(1);
+      }
+      if (!rest.empty()) {
+        rest += '-';
+      }
+      rest += part;
+    }
+    pos = end + 1;
+  }
+  argv[ConfigArg] = rest.data();
+  return opts;
+}
+
+static inline void refsched_pause() {
+#if defined(__x86_64__) || defined(_M_X64)
+  _mm_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// A unit of work in a deque. Both kinds of task derive from this.
+struct refsched_work {
+  void (*run)(refsched_work*);
+};
+
+// The deque from Chase and Lev, "Dynamic Circular Work-Stealing Deque", with
+// the memory orderings from Le et al., "Correct and Efficient Work-Stealing
+// for Weak Memory Models". Only the owner pushes and pops, at the bottom;
+// thieves steal from the top. Outgrown arrays are kept until the deque is
+// destroyed, since a thief may still be reading one.
+class refsched_chase_lev {
+  struct ring {
+    int64_t mask;
+    std::unique_ptr<std::atomic<refsched_work*>[]> items;
+
+    explicit ring(int64_t Capacity)
+        : mask(Capacity - 1),
+          items(new std::atomic<refsched_work*>[static_cast<size_t>(Capacity)]
+          ) {}
+
+    refsched_work* get(int64_t Index) const {
+      return items[static_cast<size_t>(Index & mask)].load(
+        std::memory_order_relaxed
+      );
+    }
+
+    void put(int64_t Index, refsched_work* Work) {
+      items[static_cast<size_t>(Index & mask)].store(
+        Work, std::memory_order_relaxed
+      );
+    }
+  };
+
+  alignas(64) std::atomic<int64_t> top{0};
+  alignas(64) std::atomic<int64_t> bottom{0};
+  std::atomic<ring*> array;
+  std::vector<std::unique_ptr<ring>> rings;
+
+public:
+  refsched_chase_lev() {
+    rings.push_back(std::make_unique<ring>(1024));
+    array.store(rings.back().get(), std::memory_order_relaxed);
+  }
+
+  void push(refsched_work* Work) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    ring* a = array.load(std::memory_order_relaxed);
+    if (b - t > a->mask) {
+      auto bigger = std::make_unique<ring>((a->mask + 1) * 2);
+      for (int64_t i = t; i < b; ++i) {
+        bigger->put(i, a->get(i));
+      }
+      a = bigger.get();
+      rings.push_back(std::move(bigger));
+      array.store(a, std::memory_order_release);
+    }
+    a->put(b, Work);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  refsched_work* pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    ring* a = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    refsched_work* work = a->get(b);
+    if (t == b) {
+      // The last item; race the thieves for it.
+      if (!top.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+          )) {
+        work = nullptr;
+      }
+      bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return work;
+  }
+
+  refsched_work* steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    ring* a = array.load(std::memory_order_acquire);
+    refsched_work* work = a->get(t);
+    if (!top.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        )) {
+      return nullptr;
+    }
+    return work;
+  }
+};
+
+// The same interface as refsched_chase_lev, with every operation under a
+// mutex.
+class refsched_locked_deque {
+  std::mutex mtx;
+  std::deque<refsched_work*> items;
+
+public:
+  void push(refsched_work* Work) {
+    std::lock_guard<std::mutex> lock(mtx);
+    items.push_back(Work);
+  }
+
+  refsched_work* pop() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (items.empty()) {
+      return nullptr;
+    }
+    refsched_work* work = items.back();
+    items.pop_back();
+    return work;
+  }
+
+  refsched_work* steal() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (items.empty()) {
+      return nullptr;
+    }
+    refsched_work* work = items.front();
+    items.pop_front();
+    return work;
+  }
+};
+
+class refsched_pool;
+template <typename T> class refsched_coro;
+
+struct alignas(64) refsched_worker {
+  refsched_pool* pool;
+  size_t index;
+  refsched_deque kind;
+  uint64_t rng;
+  // The last worker tried (roundrobin) or stolen from (sticky).
+  size_t last_victim;
+  refsched_chase_lev chase_lev;
+  refsched_locked_deque locked;
+
+  refsched_worker(refsched_pool* Pool, size_t Index, refsched_deque Kind)
+      : pool(Pool), index(Index), kind(Kind),
+        rng(0x9E3779B97F4A7C15ULL * (Index + 1)), last_victim(Index) {}
+
+  void push(refsched_work* Work) {
+    if (kind == refsched_deque::LOCKED) {
+      locked.push(Work);
+    } else {
+      chase_lev.push(Work);
+    }
+  }
+
+  refsched_work* pop() {
+    return kind == refsched_deque::LOCKED ? locked.pop() : chase_lev.pop();
+  }
+
+  refsched_work* steal() {
+    return kind == refsched_deque::LOCKED ? locked.steal() : chase_lev.steal();
+  }
+
+  // xorshift64
+  uint64_t next_random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+  }
+};
+
+inline thread_local refsched_worker* refsched_this_worker = nullptr;
+
+class refsched_pool {
+  // Idle rounds that the park strategy spins for before sleeping.
+  static constexpr size_t park_spins = 64;
+
+  refsched_options opts;
+  std::vector<std::unique_ptr<refsched_worker>> workers;
+  std::vector<std::thread> threads;
+  // Work submitted from threads outside of the pool
+  std::mutex injectMtx;
+  std::deque<refsched_work*> injected;
+  std::atomic<size_t> injectedCount{0};
+  // Sleeping workers wait for epoch to change
+  alignas(64) std::atomic<uint32_t> epoch{0};
+  alignas(64) std::atomic<size_t> sleepers{0};
+  // Set while a wakeup has been signaled and no sleeper has acted on it yet,
+  // so that a burst of spawns signals once rather than once per spawn
+  std::atomic<bool> wakePending{false};
+  std::atomic<bool> stopping{false};
+  // Set when the root task of run() completes
+  std::atomic<uint32_t> rootDone{0};
+
+public:
+  refsched_pool(size_t ThreadCount, refsched_options Opts) : opts(Opts) {
+    if (ThreadCount == 0) {
+      ThreadCount = 1;
+    }
+    for (size_t i = 0; i < ThreadCount; ++i) {
+      workers.push_back(std::make_unique<refsched_worker>(this, i, opts.deque));
+    }
+    for (size_t i = 0; i < ThreadCount; ++i) {
+      threads.emplace_back([this, i]() { worker_loop(*workers[i]); });
+    }
+  }
+
+  ~refsched_pool() {
+    stopping.store(true);
+    epoch.fetch_add(1);
+    epoch.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  const refsched_options& options() const { return opts; }
+
+  // Pushes Work onto the calling worker's deque, or onto the injection queue
+  // if called from outside of the pool.
+  void spawn(refsched_work* Work) {
+    trace_instant("spawn");
+    refsched_worker* self = refsched_this_worker;
+    if (self != nullptr && self->pool == this) {
+      self->push(Work);
+    } else {
+      std::lock_guard<std::mutex> lock(injectMtx);
+      injected.push_back(Work);
+      injectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (opts.idle == refsched_idle::PARK) {
+      // Pairs with the fence in idle(): either this sees the sleeper, or the
+      // sleeper sees the work.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (sleepers.load(std::memory_order_relaxed) != 0 &&
+          !wakePending.load(std::memory_order_relaxed) &&
+          !wakePending.exchange(true)) {
+        trace_instant("wake");
+        epoch.fetch_add(1);
+        epoch.notify_one();
+      }
+    }
+  }
+
+  // Returns a task from Self's own deque, then the injection queue, then
+  // another worker's deque, or nullptr if none was found.
+  refsched_work* find_work(refsched_worker& Self) {
+    if (refsched_work* work = Self.pop()) {
+      return work;
+    }
+    if (injectedCount.load(std::memory_order_relaxed) != 0) {
+      std::lock_guard<std::mutex> lock(injectMtx);
+      if (!injected.empty()) {
+        refsched_work* work = injected.front();
+        injected.pop_front();
+        injectedCount.fetch_sub(1, std::memory_order_relaxed);
+        return work;
+      }
+    }
+    return steal(Self);
+  }
+
+  // Runs Fn as a task on the pool and waits for it to complete. Only one
+  // thread may call run() at a time.
+  template <typename Fn>
+    requires std::invocable<Fn&>
+  void run(Fn&& F);
+
+  // Runs Root on the pool and returns its result once it completes. Only one
+  // thread may call run() at a time.
+  template <typename T> T run(refsched_coro<T> Root);
+
+private:
+  refsched_work* steal(refsched_worker& Self) {
+    size_t n = workers.size();
+    for (size_t attempt = 1; attempt < n; ++attempt) {
+      size_t victim;
+      if (opts.victim == refsched_victim::ROUND_ROBIN) {
+        victim = (Self.last_victim + 1) % n;
+        if (victim == Self.index) {
+          victim = (victim + 1) % n;
+        }
+        Self.last_victim = victim;
+      } else if (opts.victim == refsched_victim::STICKY && attempt == 1 &&
+                 Self.last_victim != Self.index) {
+        victim = Self.last_victim;
+      } else {
+        victim = static_cast<size_t>(Self.next_random() % (n - 1));
+        if (victim >= Self.index) {
+          ++victim;
+        }
+      }
+      if (refsched_work* work = workers[victim]->steal()) {
+        trace_instant("steal", static_cast<int64_t>(victim));
+        if (opts.victim == refsched_victim::STICKY) {
+          Self.last_victim = victim;
+        }
+        return work;
+      }
+    }
+    return nullptr;
+  }
+
+  // Called after Rounds consecutive failures to find work. May return work
+  // that was found while preparing to sleep.
+  refsched_work* idle(refsched_worker& Self, size_t Rounds) {
+    if (Rounds == 0) {
+      // Only the first failure after running a task, so that spinning
+      // workers don't fill their trace buffers.
+      trace_instant("steal_fail");
+    }
+    if (opts.idle == refsched_idle::SPIN ||
+        (opts.idle == refsched_idle::PARK && Rounds < park_spins)) {
+      refsched_pause();
+      return nullptr;
+    }
+    if (opts.idle == refsched_idle::YIELD) {
+      std::this_thread::yield();
+      return nullptr;
+    }
+    uint32_t e = epoch.load();
+    sleepers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    refsched_work* work = find_work(Self);
+    if (work == nullptr && !stopping.load()) {
+      trace_begin("sleep");
+      epoch.wait(e);
+      trace_end("sleep");
+    }
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+    // Every registered sleeper passes here once the epoch changes, so a
+    // pending wakeup can't be left set with no one to clear it.
+    wakePending.store(false, std::memory_order_relaxed);
+    return work;
+  }
+
+  void worker_loop(refsched_worker& Self) {
+    refsched_this_worker = &Self;
+    size_t idleRounds = 0;
+    while (!stopping.load(std::memory_order_relaxed)) {
+      refsched_work* work = find_work(Self);
+      if (work == nullptr) {
+        work = idle(Self, idleRounds++);
+      }
+      if (work != nullptr) {
+        idleRounds = 0;
+        work->run(work);
+      }
+    }
+  }
+};
+
+// A task that runs a lambda once and deletes itself.
+template <typename Fn> struct refsched_closure : refsched_work {
+  Fn fn;
+
+  template <typename F>
+  explicit refsched_closure(F&& Func)
+      : refsched_work{&execute}, fn(std::forward<F>(Func)) {}
+
+  static void execute(refsched_work* Work) {
+    auto* self = static_cast<refsched_closure*>(Work);
+    self->fn();
+    delete self;
+  }
+};
+
+template <typename Fn>
+static inline refsched_work* refsched_make_closure(Fn&& F) {
+  return new refsched_closure<std::decay_t<Fn>>(std::forward<Fn>(F));
+}
+
+// Forks lambdas as tasks onto the calling worker's deque. wait() runs other
+// tasks, including stolen ones, until all of the group's tasks have completed.
+// Must be used from a worker thread.
+class refsched_task_group {
+  std::atomic<size_t> pending{0};
+
+public:
+  template <typename Fn> void run(Fn&& F) {
+    pending.fetch_add(1, std::memory_order_relaxed);
+    refsched_this_worker->pool->spawn(
+      refsched_make_closure([this, f = std::forward<Fn>(F)]() mutable {
+        f();
+        pending.fetch_sub(1, std::memory_order_release);
+      })
+    );
+  }
+
+  void wait() {
+    refsched_worker& self = *refsched_this_worker;
+    while (pending.load(std::memory_order_acquire) != 0) {
+      if (refsched_work* work = self.pool->find_work(self)) {
+        work->run(work);
+      } else {
+        refsched_pause();
+      }
+    }
+  }
+};
+
+template <typename Fn>
+  requires std::invocable<Fn&>
+void refsched_pool::run(Fn&& F) {
+  rootDone.store(0, std::memory_order_relaxed);
+  spawn(refsched_make_closure([this, &F]() {
+    F();
+    rootDone.store(1, std::memory_order_release);
+    rootDone.notify_one();
+  }));
+  rootDone.wait(0, std::memory_order_acquire);
+}
+
+class refsched_fork_group;
+
+// The part of a refsched_coro's promise that doesn't depend on its result
+// type. Resuming the coroutine from a deque runs it.
+struct refsched_promise_base : refsched_work {
+  std::coroutine_handle<> frame;
+  // The parent's group, or nullptr for the root
+  refsched_fork_group* group = nullptr;
+  std::atomic<uint32_t>* rootDone = nullptr;
+
+  refsched_promise_base() : refsched_work{&execute} {}
+
+  static void execute(refsched_work* Work) {
+    static_cast<refsched_promise_base*>(Work)->frame.resume();
+  }
+
+  // Destroys the completed coroutine and resumes its parent if this was its
+  // last outstanding child.
+  struct final_awaiter {
+    bool await_ready() noexcept { return false; }
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> H) noexcept;
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  final_awaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() { std::terminate(); }
+};
+
+template <typename T> struct refsched_promise : refsched_promise_base {
+  T* result = nullptr;
+
+  refsched_coro<T> get_return_object() noexcept;
+  void return_value(T Value) { *result = std::move(Value); }
+};
+
+template <> struct refsched_promise<void> : refsched_promise_base {
+  refsched_coro<void> get_return_object() noexcept;
+  void return_void() {}
+};
+
+// A coroutine task that starts suspended. It runs once it's forked into a
+// refsched_fork_group or passed to refsched_pool::run().
+template <typename T> class [[nodiscard]] refsched_coro {
+public:
+  using promise_type = refsched_promise<T>;
+
+  explicit refsched_coro(std::coroutine_handle<promise_type> Handle)
+      : handle(Handle) {}
+  refsched_coro(refsched_coro&& Other) noexcept
+      : handle(std::exchange(Other.handle, {})) {}
+  refsched_coro& operator=(refsched_coro&&) = delete;
+  ~refsched_coro() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+
+  std::coroutine_handle<promise_type> release() {
+    return std::exchange(handle, {});
+  }
+
+private:
+  std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T>
+refsched_coro<T> refsched_promise<T>::get_return_object() noexcept {
+  auto handle = std::coroutine_handle<refsched_promise>::from_promise(*this);
+  frame = handle;
+  return refsched_coro<T>(handle);
+}
+
+inline refsched_coro<void>
+refsched_promise<void>::get_return_object() noexcept {
+  auto handle = std::coroutine_handle<refsched_promise>::from_promise(*this);
+  frame = handle;
+  return refsched_coro<void>(handle);
+}
+
+// Forks child coroutines onto the calling worker's deque. co_await suspends
+// the parent until all of them have completed; the last child to complete
+// resumes it on that child's thread. The group can be reused after co_await.
+class refsched_fork_group {
+  // One for each outstanding child, plus one until the parent suspends
+  std::atomic<size_t> count{1};
+  std::coroutine_handle<> parent;
+
+public:
+  template <typename T> void fork(refsched_coro<T>&& Child, T* Result) {
+    auto handle = Child.release();
+    handle.promise().result = Result;
+    fork_handle(handle.promise());
+  }
+
+  void fork(refsched_coro<void>&& Child) {
+    fork_handle(Child.release().promise());
+  }
+
+  // Called by each child as it completes. Returns the coroutine to resume.
+  std::coroutine_handle<> child_done() noexcept {
+    if (count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      return parent;
+    }
+    return std::noop_coroutine();
+  }
+
+  bool await_ready() noexcept {
+    return count.load(std::memory_order_acquire) == 1;
+  }
+
+  bool await_suspend(std::coroutine_handle<> Parent) noexcept {
+    parent = Parent;
+    // If the children have all completed already, don't suspend.
+    return count.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+
+  void await_resume() noexcept { count.store(1, std::memory_order_relaxed); }
+
+private:
+  void fork_handle(refsched_promise_base& Child) {
+    Child.group = this;
+    count.fetch_add(1, std::memory_order_relaxed);
+    refsched_this_worker->pool->spawn(&Child);
+  }
+};
+
+template <typename P>
+std::coroutine_handle<> refsched_promise_base::final_awaiter::await_suspend(
+  std::coroutine_handle<P> H
+) noexcept {
+  refsched_promise_base& promise = H.promise();
+  refsched_fork_group* group = promise.group;
+  std::atomic<uint32_t>* rootDone = promise.rootDone;
+  H.destroy();
+  if (group != nullptr) {
+    return group->child_done();
+  }
+  rootDone->store(1, std::memory_order_release);
+  rootDone->notify_one();
+  return std::noop_coroutine();
+}
+
+template <typename T> T refsched_pool::run(refsched_coro<T> Root) {
+  auto handle = Root.release();
+  auto& promise = handle.promise();
+  promise.rootDone = &rootDone;
+  rootDone.store(0, std::memory_order_relaxed);
+  if constexpr (std::is_void_v<T>) {
+    spawn(&promise);
+    rootDone.wait(0, std::memory_order_acquire);
+  } else {
+    T result{};
+    promise.result = &result;
+    spawn(&promise);
+    rootDone.wait(0, std::memory_order_acquire);
+    return result;
+  }
+}
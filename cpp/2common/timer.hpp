@@ -0,0 +1,74 @@
+#pragma once
+#include "histogram.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Each task arms timers one after another, like a service that arms a timeout
+// on every request. Most timers are allowed to fire after a random duration.
+// The rest are armed with a long duration and cancelled immediately, as
+// happens when the request completes before its timeout.
+static constexpr size_t timer_count = 1000000;
+static constexpr uint64_t timer_min_us = 50;
+static constexpr uint64_t timer_max_us = 1000;
+static constexpr uint64_t timer_cancel_us = 1000000;
+static constexpr size_t timer_cancel_every = 4;
+
+struct timer_op {
+  uint64_t duration_us;
+  bool cancel;
+};
+
+// Returns the deterministic duration and cancellation choice for the Index'th
+// timer of a task.
+static inline timer_op timer_make_op(size_t Task, size_t Index) {
+  uint64_t x = static_cast<uint64_t>(Task) * 0x9E3779B97F4A7C15ULL +
+               static_cast<uint64_t>(Index);
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  if (x % timer_cancel_every == 0) {
+    return timer_op{timer_cancel_us, true};
+  }
+  return timer_op{
+    timer_min_us + (x >> 8) % (timer_max_us - timer_min_us), false
+  };
+}
+
+// Splits timer_count across TaskCount tasks.
+static inline size_t timer_ops_for_task(size_t Task, size_t TaskCount) {
+  size_t per_task = timer_count / TaskCount;
+  size_t rem = timer_count % TaskCount;
+  return Task < rem ? per_task + 1 : per_task;
+}
+
+// Per-task results, merged after all tasks complete. Lateness is the time
+// between a timer's deadline and the task resuming.
+struct timer_result {
+  size_t fired = 0;
+  size_t cancelled = 0;
+  size_t failed = 0;
+  latency_histogram lateness;
+
+  void merge(const timer_result& other) {
+    fired += other.fired;
+    cancelled += other.cancelled;
+    failed += other.failed;
+    lateness.merge(other.lateness);
+  }
+};
+
+static inline size_t timer_expected_cancelled(size_t TaskCount) {
+  size_t n = 0;
+  for (size_t t = 0; t < TaskCount; ++t) {
+    size_t ops = timer_ops_for_task(t, TaskCount);
+    for (size_t i = 0; i < ops; ++i) {
+      if (timer_make_op(t, i).cancel) {
+        ++n;
+      }
+    }
+  }
+  return n;
+}
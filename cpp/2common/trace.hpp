@@ -0,0 +1,168 @@
+#pragma once
+#include <cstdint>
+
+// Optional tracing of scheduling events, for looking at a timeline of what
+// each worker was doing during a run. It is compiled in only when SCHED_TRACE
+// is defined (configure with -DSCHED_TRACE=ON); otherwise every function here
+// is empty.
+//
+// Each thread records into its own ring buffer of trace_capacity events, so
+// recording is a plain store by the only writer, and a long run keeps its most
+// recent events. At exit, all buffers are written as a Chrome trace (JSON
+// Trace Event Format, which Perfetto and chrome://tracing open) to the path in
+// the TRACE_FILE environment variable, or trace.json. Spans are balanced when
+// written: a span still open at exit (e.g. a worker that never left its
+// arena) is closed at the time of writing, and an end whose begin was
+// overwritten in the ring buffer is dropped.
+//
+// Event names used by the runtimes:
+// - refsched: spawn, steal (arg: victim worker), steal_fail and wake as
+//   instant events, and sleep as a span while a worker is parked
+// - tbb: arena, a span while the thread is in an arena. Workers leave the
+//   arena when they run out of work, so the gaps are idle time
+// - taskflow: task, a span while the thread runs a task
+// Other runtimes, such as libfork and TooManyCooks, aren't instrumented: they
+// don't expose hooks for scheduling events (TooManyCooks only reports thread
+// start and stop).
+
+#ifdef SCHED_TRACE
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+inline constexpr size_t trace_capacity = size_t{1} << 20;
+
+struct trace_record {
+  uint64_t ns;
+  const char* name;
+  int64_t arg;
+  char phase;
+};
+
+struct trace_buffer {
+  std::unique_ptr<trace_record[]> records{new trace_record[trace_capacity]};
+  std::atomic<size_t> count{0};
+  uint32_t tid = 0;
+  trace_buffer* next = nullptr;
+};
+
+inline std::atomic<trace_buffer*> trace_head{nullptr};
+inline std::atomic<uint32_t> trace_thread_count{0};
+inline const std::chrono::steady_clock::time_point trace_start =
+  std::chrono::steady_clock::now();
+
+static inline void trace_write();
+
+// Buffers are never freed, so that events from exited threads are kept.
+static inline trace_buffer& trace_local() {
+  thread_local trace_buffer* buffer = [] {
+    auto* b = new trace_buffer;
+    b->tid = trace_thread_count.fetch_add(1, std::memory_order_relaxed);
+    if (b->tid == 0) {
+      std::atexit(trace_write);
+    }
+    b->next = trace_head.load(std::memory_order_relaxed);
+    while (!trace_head.compare_exchange_weak(
+      b->next, b, std::memory_order_release, std::memory_order_relaxed
+    )) {
+    }
+    return b;
+  }();
+  return *buffer;
+}
+
+static inline void trace_event(char Phase, const char* Name, int64_t Arg) {
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - trace_start
+  );
+  trace_buffer& b = trace_local();
+  size_t i = b.count.load(std::memory_order_relaxed);
+  b.records[i % trace_capacity] = {
+    static_cast<uint64_t>(ns.count()), Name, Arg, Phase
+  };
+  b.count.store(i + 1, std::memory_order_release);
+}
+
+// Name must be a string literal, since only the pointer is recorded.
+static inline void trace_instant(const char* Name, int64_t Arg = -1) {
+  trace_event('i', Name, Arg);
+}
+static inline void trace_begin(const char* Name) { trace_event('B', Name, -1); }
+static inline void trace_end(const char* Name) { trace_event('E', Name, -1); }
+
+static inline void trace_write_record(
+  std::FILE* Out, uint32_t Tid, const char* Name, char Phase, uint64_t Ns,
+  int64_t Arg
+) {
+  std::fprintf(
+    Out, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+    Name, Phase, static_cast<double>(Ns) / 1000.0, Tid
+  );
+  if (Phase == 'i') {
+    std::fprintf(Out, ",\"s\":\"t\"");
+  }
+  if (Arg >= 0) {
+    std::fprintf(Out, ",\"args\":{\"arg\":%lld}", static_cast<long long>(Arg));
+  }
+  std::fprintf(Out, "}");
+}
+
+static inline void trace_write() {
+  auto writeNs = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - trace_start
+    )
+      .count()
+  );
+  const char* path = std::getenv("TRACE_FILE");
+  if (path == nullptr || *path == '\0') {
+    path = "trace.json";
+  }
+  std::FILE* out = std::fopen(path, "w");
+  if (out == nullptr) {
+    std::fprintf(stderr, "trace: can't open %s\n", path);
+    return;
+  }
+  std::fprintf(out, "{\"traceEvents\":[\n");
+  bool first = true;
+  for (auto* b = trace_head.load(std::memory_order_acquire); b != nullptr;
+       b = b->next) {
+    std::fprintf(
+      out,
+      "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+      "\"args\":{\"name\":\"thread %u\"}}",
+      first ? "" : ",\n", b->tid, b->tid
+    );
+    first = false;
+    size_t end = b->count.load(std::memory_order_acquire);
+    size_t begin = end > trace_capacity ? end - trace_capacity : 0;
+    std::vector<const char*> open;
+    for (size_t i = begin; i < end; ++i) {
+      const trace_record& r = b->records[i % trace_capacity];
+      if (r.phase == 'B') {
+        open.push_back(r.name);
+      } else if (r.phase == 'E') {
+        if (open.empty()) {
+          continue;
+        }
+        open.pop_back();
+      }
+      trace_write_record(out, b->tid, r.name, r.phase, r.ns, r.arg);
+    }
+    for (size_t i = open.size(); i > 0; --i) {
+      trace_write_record(out, b->tid, open[i - 1], 'E', writeNs, -1);
+    }
+  }
+  std::fprintf(out, "\n]}\n");
+  std::fclose(out);
+  std::fprintf(stderr, "trace: wrote %s\n", path);
+}
+#else
+static inline void trace_instant(const char*, int64_t = -1) {}
+static inline void trace_begin(const char*) {}
+static inline void trace_end(const char*) {}
+#endif
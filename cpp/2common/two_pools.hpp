@@ -0,0 +1,65 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <latch>
+#include <thread>
+
+// The "2pool" config splits thread_count between two independent pools in the
+// same process and runs the benchmark on both at once, as when several
+// libraries' pools run side by side. Fairness is the ratio of the faster
+// pool's duration to the slower one's; 100 means both finished together.
+struct two_pools_result {
+  size_t wall_us;
+  std::array<size_t, 2> pool_us;
+
+  void print_yaml() const {
+    size_t fast = pool_us[0] < pool_us[1] ? pool_us[0] : pool_us[1];
+    size_t slow = pool_us[0] < pool_us[1] ? pool_us[1] : pool_us[0];
+    std::printf("    duration: %zu us\n", wall_us);
+    std::printf("    pool_0_duration: %zu us\n", pool_us[0]);
+    std::printf("    pool_1_duration: %zu us\n", pool_us[1]);
+    std::printf(
+      "    fairness_pct: %zu\n", slow == 0 ? size_t{100} : fast * 100 / slow
+    );
+  }
+};
+
+// The number of threads for pool Pool (0 or 1) out of ThreadCount.
+static inline size_t two_pools_threads(size_t ThreadCount, size_t Pool) {
+  size_t threads = Pool == 0 ? (ThreadCount + 1) / 2 : ThreadCount / 2;
+  return threads == 0 ? 1 : threads;
+}
+
+// Calls Run(0) and Run(1) on two separate threads, released together, and
+// times each. Run(Pool) should run one iteration of the benchmark on that
+// pool and return when it completes.
+template <typename Fn> two_pools_result two_pools_run(Fn&& Run) {
+  two_pools_result result;
+  std::latch start(3);
+  auto timed = [&](size_t Pool) {
+    start.arrive_and_wait();
+    auto startTime = std::chrono::high_resolution_clock::now();
+    Run(Pool);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    result.pool_us[Pool] = static_cast<size_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        endTime - startTime
+      )
+        .count()
+    );
+  };
+  std::thread pool0(timed, 0);
+  std::thread pool1(timed, 1);
+  auto startTime = std::chrono::high_resolution_clock::now();
+  start.arrive_and_wait();
+  pool0.join();
+  pool1.join();
+  auto endTime = std::chrono::high_resolution_clock::now();
+  result.wall_us = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+  return result;
+}
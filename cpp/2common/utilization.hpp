@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#ifdef ALLOC_STATS
+#include "alloc_count.hpp"
+#endif
+
+#ifdef __linux__
+#include <cstdlib>
+#include <ctime>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+// Worker utilization over a timed region, to tell load imbalance apart from
+// contention when a runtime scales poorly. utilization_now() reads the CPU
+// time of every thread in the process; call it at the start and end of the
+// region, and utilization_between() reports how busy the workers were:
+// - busy_min_pct / busy_max_pct / busy_mean_pct: each worker's CPU time as a
+//   percentage of the wall time of the region
+// - imbalance_gini: the Gini coefficient of the workers' CPU times; 0 when
+//   every worker was busy for the same time, approaching 1 when one worker did
+//   all of it
+//
+// The workers are the Workers threads that used the most CPU in the region,
+// which excludes a main thread that only blocks on the result, and counts a
+// worker that never woke up as 0% busy. CPU time includes spinning while
+// looking for work, so a runtime that spins when idle shows as busy; low busy
+// times with a low imbalance point at workers sleeping, and a high imbalance
+// at the work not reaching some of them.
+//
+// This is only implemented on Linux (threads are listed from /proc/self/task);
+// elsewhere nothing is printed.
+//
+// When built with ALLOC_STATS (configure with -DALLOC_STATS=ON), this also
+// replaces operator new to count the allocations made in the region (see
+// alloc_count.hpp), and reports:
+// - allocations / alloc_bytes: the number and total size of allocations
+// - common_alloc_size: the most common allocation size, which is the task or
+//   coroutine frame size in runtimes that allocate one per task
+// - max_live_allocs: the most allocations live at once, above those live at
+//   the start; for a recursive benchmark, how many frames it needs at a time
+// Runtimes that place tasks on their own stacks or pools (e.g. libfork's
+// stacks, or tbb's and OpenMP's task allocators) make few allocations here,
+// and their memory per task only shows in max_rss.
+struct utilization_sample {
+  std::chrono::steady_clock::time_point time;
+  // (thread id, CPU time in ns)
+  std::vector<std::pair<long, uint64_t>> threads;
+#ifdef ALLOC_STATS
+  // Taken before and after the sample's own allocations (threads), so that
+  // they don't count towards the region
+  alloc_stats allocs_before;
+  alloc_stats allocs_after;
+#endif
+};
+
+#ifdef __linux__
+// Reads the thread's CPU clock, which is exact even while the thread is
+// running. The clock id of another thread in the process is built the same
+// way pthread_getcpuclockid() does; if that fails, falls back to /proc stat,
+// which is in clock ticks (usually 10ms).
+static inline bool utilization_thread_ns(long Tid, uint64_t& Ns) {
+  clockid_t clock = static_cast<clockid_t>((~Tid << 3) | 6);
+  timespec ts;
+  if (clock_gettime(clock, &ts) == 0) {
+    Ns = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull +
+         static_cast<uint64_t>(ts.tv_nsec);
+    return true;
+  }
+  char path[64];
+  std::snprintf(path, sizeof(path), "/proc/self/task/%ld/stat", Tid);
+  std::FILE* f = std::fopen(path, "r");
+  if (f == nullptr) {
+    return false;
+  }
+  char buf[1024];
+  size_t len = std::fread(buf, 1, sizeof(buf) - 1, f);
+  std::fclose(f);
+  buf[len] = '\0';
+  // The command name may contain spaces, so skip past its closing paren
+  // before counting fields; utime and stime are fields 14 and 15.
+  const char* p = nullptr;
+  for (size_t i = 0; i < len; ++i) {
+    if (buf[i] == ')') {
+      p = buf + i + 1;
+    }
+  }
+  unsigned long long utime, stime;
+  if (p == nullptr ||
+      std::sscanf(
+        p, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime,
+        &stime
+      ) != 2) {
+    return false;
+  }
+  Ns = (utime + stime) * 1000000000ull /
+       static_cast<unsigned long long>(sysconf(_SC_CLK_TCK));
+  return true;
+}
+#endif
+
+static inline utilization_sample utilization_now() {
+  utilization_sample sample;
+#ifdef ALLOC_STATS
+  sample.allocs_before = alloc_stats_now();
+#endif
+#ifdef __linux__
+  if (DIR* dir = opendir("/proc/self/task")) {
+    while (dirent* entry = readdir(dir)) {
+      if (entry->d_name[0] == '.') {
+        continue;
+      }
+      long tid = std::strtol(entry->d_name, nullptr, 10);
+      uint64_t ns;
+      if (utilization_thread_ns(tid, ns)) {
+        sample.threads.emplace_back(tid, ns);
+      }
+    }
+    closedir(dir);
+  }
+#endif
+#ifdef ALLOC_STATS
+  sample.allocs_after = alloc_stats_now();
+#endif
+  sample.time = std::chrono::steady_clock::now();
+  return sample;
+}
+
+struct utilization_result {
+  double busy_min_pct = 0.0;
+  double busy_max_pct = 0.0;
+  double busy_mean_pct = 0.0;
+  double imbalance_gini = 0.0;
+  bool valid = false;
+#ifdef ALLOC_STATS
+  size_t allocations = 0;
+  size_t alloc_bytes = 0;
+  size_t common_alloc_size = 0;
+  size_t max_live_allocs = 0;
+#endif
+
+  void print_yaml() const {
+#ifdef ALLOC_STATS
+    std::printf("    allocations: %zu\n", allocations);
+    std::printf("    alloc_bytes: %zu\n", alloc_bytes);
+    std::printf("    common_alloc_size: %zu\n", common_alloc_size);
+    std::printf("    max_live_allocs: %zu\n", max_live_allocs);
+#endif
+    if (!valid) {
+      return;
+    }
+    std::printf("    busy_min_pct: %.1f\n", busy_min_pct);
+    std::printf("    busy_max_pct: %.1f\n", busy_max_pct);
+    std::printf("    busy_mean_pct: %.1f\n", busy_mean_pct);
+    std::printf("    imbalance_gini: %.3f\n", imbalance_gini);
+  }
+};
+
+static inline utilization_result utilization_between(
+  const utilization_sample& Start, const utilization_sample& End,
+  size_t Workers
+) {
+  utilization_result result;
+#ifdef ALLOC_STATS
+  const alloc_stats& start = Start.allocs_after;
+  const alloc_stats& end = End.allocs_before;
+  result.allocations = end.count - start.count;
+  result.alloc_bytes = end.bytes - start.bytes;
+  result.common_alloc_size = alloc_common_size(start, end);
+  result.max_live_allocs = end.peak > start.live ? end.peak - start.live : 0;
+#endif
+  if (End.threads.empty() || Workers == 0) {
+    return result;
+  }
+  // Threads started during the region count from 0.
+  std::vector<uint64_t> busy;
+  for (auto& [tid, ns] : End.threads) {
+    uint64_t before = 0;
+    for (auto& [startTid, startNs] : Start.threads) {
+      if (startTid == tid) {
+        before = startNs;
+        break;
+      }
+    }
+    busy.push_back(ns > before ? ns - before : 0);
+  }
+  // Keep the Workers busiest threads, then sort ascending for the Gini sum.
+  std::sort(busy.begin(), busy.end(), std::greater<uint64_t>{});
+  busy.resize(Workers, 0);
+  std::sort(busy.begin(), busy.end());
+
+  double wallNs = static_cast<double>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(End.time - Start.time)
+      .count()
+  );
+  if (wallNs <= 0.0) {
+    return result;
+  }
+  double total = 0.0;
+  double weighted = 0.0;
+  for (size_t i = 0; i < Workers; ++i) {
+    total += static_cast<double>(busy[i]);
+    weighted += static_cast<double>(2 * i + 1) * static_cast<double>(busy[i]);
+  }
+  double n = static_cast<double>(Workers);
+  result.busy_min_pct = static_cast<double>(busy.front()) * 100.0 / wallNs;
+  result.busy_max_pct = static_cast<double>(busy.back()) * 100.0 / wallNs;
+  result.busy_mean_pct = total / n * 100.0 / wallNs;
+  result.imbalance_gini = total == 0.0 ? 0.0 : weighted / (n * total) - 1.0;
+  result.valid = true;
+  return result;
+}
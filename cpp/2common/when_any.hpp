@@ -0,0 +1,108 @@
+#pragma once
+#include "histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Each race starts TaskCount tasks with random costs and takes the result of
+// whichever finishes first. The remaining tasks are losers. Where the runtime
+// has a cancellation mechanism the losers are cancelled. Otherwise a shared
+// flag is set once the winner is known. Losers poll for cancellation between
+// work units, and each race waits for every loser to stop before the next
+// race starts.
+inline constexpr size_t when_any_race_count = 10000;
+inline constexpr size_t when_any_min_units = 10;
+inline constexpr size_t when_any_max_units = 1000;
+
+// One unit of work is roughly 0.1us.
+static inline uint64_t when_any_unit(uint64_t Value) {
+  for (size_t i = 0; i < 64; ++i) {
+    Value = Value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return Value;
+}
+
+struct when_any_race {
+  std::vector<size_t> cost;
+  std::vector<size_t> units;
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> checksum{0};
+  std::chrono::steady_clock::time_point start;
+
+  when_any_race(size_t Race, size_t TaskCount)
+      : cost(TaskCount), units(TaskCount, 0) {
+    for (size_t i = 0; i < TaskCount; ++i) {
+      uint64_t x = static_cast<uint64_t>(Race) * 0x9E3779B97F4A7C15ULL + i;
+      x ^= x >> 31;
+      x *= 0xBF58476D1CE4E5B9ULL;
+      x ^= x >> 29;
+      cost[i] =
+        when_any_min_units + x % (when_any_max_units - when_any_min_units);
+    }
+    start = std::chrono::steady_clock::now();
+  }
+
+  bool cancelled() const { return done.load(std::memory_order_relaxed); }
+
+  // The body of task Index. IsCancelled is polled between work units. Returns
+  // Index as the task's result, so the caller can tell which task won.
+  template <typename Fn> size_t run(size_t Index, Fn&& IsCancelled) {
+    uint64_t value = Index;
+    size_t i = 0;
+    for (; i < cost[Index]; ++i) {
+      if (IsCancelled()) {
+        break;
+      }
+      value = when_any_unit(value);
+    }
+    checksum.fetch_add(value, std::memory_order_relaxed);
+    units[Index] = i;
+    return Index;
+  }
+
+  size_t run(size_t Index) {
+    return run(Index, [this]() { return cancelled(); });
+  }
+};
+
+struct when_any_stats {
+  latency_histogram first;
+  size_t winner_units = 0;
+  size_t loser_units = 0;
+  size_t wrong_results = 0;
+
+  // Call when the winner is known.
+  void record_first(const when_any_race& Race) {
+    auto now = std::chrono::steady_clock::now();
+    first.record(static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - Race.start)
+        .count()
+    ));
+  }
+
+  // Call after every task in the race has stopped. The winner must have
+  // completed all of its work.
+  void record_done(const when_any_race& Race, size_t Winner) {
+    if (Winner >= Race.cost.size() ||
+        Race.units[Winner] != Race.cost[Winner]) {
+      ++wrong_results;
+      return;
+    }
+    for (size_t i = 0; i < Race.units.size(); ++i) {
+      if (i == Winner) {
+        winner_units += Race.units[i];
+      } else {
+        loser_units += Race.units[i];
+      }
+    }
+  }
+
+  // The share of all work units that was spent on losers.
+  size_t loser_work_pct() const {
+    size_t total = winner_units + loser_units;
+    return total == 0 ? 0 : loser_units * 100 / total;
+  }
+};
@@ -0,0 +1,168 @@
+// Test the cost of exception propagation through a fork-join tree.
+// A skynet-shaped tree is run repeatedly, with a configurable fraction of
+// leaves throwing. Reports the time taken by rounds that complete normally
+// and by rounds that deliver an exception to the root.
+// The workload is defined in 2common/exception_storm.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "exception_storm.hpp"
+#include "hpx/async_combinators/when_all.hpp"
+#include "memusage.hpp"
+#include <hpx/future.hpp>
+#include <hpx/init.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t ppm = 0;
+
+// An exception thrown by a child is stored in its future and rethrown when
+// the parent awaits it. If the inline child throws, the parent still waits
+// for the forked siblings before rethrowing, so that no child outlives its
+// parent. A coroutine can't co_await in a catch handler, so the exception is
+// held in an exception_ptr until then.
+template <size_t DepthMax>
+hpx::future<size_t> storm_one(size_t Round, size_t BaseNum, size_t Depth) {
+  if (Depth == DepthMax) {
+    co_return exception_storm_leaf(Round, BaseNum, ppm);
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
+    depthOffset *= 10;
+  }
+
+  std::array<hpx::future<size_t>, 9> futures;
+  for (size_t idx = 0; idx < 9; ++idx) {
+    futures[idx] = hpx::async(
+      storm_one<DepthMax>, Round, BaseNum + depthOffset * idx, Depth + 1
+    );
+  }
+
+  // Fork 9, run 1 synchronously
+  size_t count = 0;
+  std::exception_ptr inlineError;
+  try {
+    count = co_await storm_one<DepthMax>(
+      Round, BaseNum + depthOffset * 9, Depth + 1
+    );
+  } catch (...) {
+    inlineError = std::current_exception();
+  }
+
+  auto results = co_await hpx::when_all(futures);
+  if (inlineError) {
+    std::rethrow_exception(inlineError);
+  }
+
+  for (auto& f : results) {
+    count += co_await f;
+  }
+  co_return count;
+}
+
+static void run_rounds(exception_storm_stats& Stats) {
+  for (size_t round = 0; round < exception_storm_rounds; ++round) {
+    auto start = std::chrono::steady_clock::now();
+    size_t result = 0;
+    bool threw = false;
+    try {
+      result = storm_one<exception_storm_depth>(round, 0, 0).get();
+    } catch (const exception_storm_error&) {
+      threw = true;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    Stats.record(round, threw, result, elapsed);
+  }
+}
+
+int hpx_main(hpx::program_options::variables_map&) {
+  hpx::threads::set_scheduler_mode(
+    hpx::threads::policies::scheduler_mode::enable_stealing |
+    hpx::threads::policies::scheduler_mode::enable_stealing_numa |
+    hpx::threads::policies::scheduler_mode::assign_work_thread_parent |
+    hpx::threads::policies::scheduler_mode::steal_after_local
+  );
+
+  {
+    exception_storm_stats stats(ppm);
+    run_rounds(stats); // warmup
+  }
+
+  exception_storm_stats stats(ppm);
+  auto startTime = std::chrono::high_resolution_clock::now();
+  run_rounds(stats);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  if (stats.wrong_results != 0) {
+    std::printf(
+      "FAIL: %zu of %zu rounds had the wrong outcome\n", stats.wrong_results,
+      exception_storm_rounds
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    rounds: %zu\n", exception_storm_rounds);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    rounds/sec: %zu\n",
+    static_cast<size_t>(exception_storm_rounds * 1000000 / totalTimeUs)
+  );
+  std::printf("    failed_rounds: %zu\n", stats.failed_rounds);
+  std::printf("    ok_round: %zu us\n", stats.ok_round_us());
+  std::printf("    failed_round: %zu us\n", stats.failed_round_us());
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+
+  return hpx::local::finalize();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    ppm = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("throw_ppm: %zu\n", ppm);
+
+  hpx::local::init_params init_args;
+  init_args.cfg = {
+    "hpx.os_threads=" + std::to_string(thread_count),
+    "hpx.stacks.small_size=0x4000", "hpx.stacks.use_guard_pages=0"
+  };
+
+  return hpx::local::init(hpx_main, argc, argv, init_args);
+}
@@ -26,7 +26,9 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 #include <hpx/future.hpp>
 #include <hpx/init.hpp>
 
@@ -41,8 +43,8 @@ static const size_t iter_count = 1;
 static size_t fib_n = 0;
 
 hpx::future<size_t> fib(size_t n) {
-  if (n < 2)
-    co_return n;
+  if (n < fib_cutoff)
+    co_return fib_serial(n);
 
   // Adding hpx::launch::fork increases the speed of the other benchmarks.
   // However, it also increases memory consumption, and on this benchmark causes
@@ -93,6 +95,7 @@ int hpx_main(hpx::program_options::variables_map&) {
 
   auto result = fib(30).get(); // warmup
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -101,11 +104,13 @@ int hpx_main(hpx::program_options::variables_map&) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 
   return hpx::local::finalize();
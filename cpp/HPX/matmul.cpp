@@ -8,6 +8,7 @@
 // file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include "matmul.hpp"
+#include "utilization.hpp"
 
 #include "memusage.hpp"
 #include <hpx/experimental/task_group.hpp>
@@ -17,84 +18,72 @@
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
-#include <exception>
 #include <string>
-#include <vector>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
-static int matmul_n = 0;
+static matmul_args args;
 
 // For the matmul implementation we use the stackful coroutines of HPX
 // since it offers much better performance, and the high memory consumption
 // issue (as seen in the other benchmarks) is not present here due to low
 // recursion depth.
-void matmul(int* a, int* b, int* c, int n, int N) {
-  if (n <= 32) {
-    matmul_small(a, b, c, n, N);
+template <typename T> void matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
+    matmul_small(t, N);
   } else {
-    int k = n / 2;
+    auto s = matmul_split(t, N);
 
     {
       hpx::experimental::task_group tg;
-      tg.run(matmul, a, b, c, k, N);
-      tg.run(matmul, a, b + k, c + k, k, N);
-      tg.run(matmul, a + k * N, b, c + k * N, k, N);
+      tg.run(matmul<T>, s[0], N);
+      tg.run(matmul<T>, s[1], N);
+      tg.run(matmul<T>, s[2], N);
       // Fork 3, run 1 synchronously
-      matmul(a + k * N, b + k, c + k * N + k, k, N);
+      matmul(s[3], N);
       tg.wait();
     }
 
     {
       hpx::experimental::task_group tg;
-      tg.run(matmul, a + k, b + k * N, c, k, N);
-      tg.run(matmul, a + k, b + k * N + k, c + k, k, N);
-      tg.run(matmul, a + k * N + k, b + k * N, c + k * N, k, N);
+      tg.run(matmul<T>, s[4], N);
+      tg.run(matmul<T>, s[5], N);
+      tg.run(matmul<T>, s[6], N);
       // Fork 3, run 1 synchronously
-      matmul(a + k * N + k, b + k * N + k, c + k * N + k, k, N);
+      matmul(s[7], N);
       tg.wait();
     }
   }
 }
 
-std::vector<int> run_matmul(int N) {
-  std::vector<int> A(N * N, 1);
-  std::vector<int> B(N * N, 1);
-  std::vector<int> C(N * N, 0);
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  matmul_matrices<T>& M, utilization_result* Cpu = nullptr
+) {
+  M.init();
 
-  int* a = A.data();
-  int* b = B.data();
-  int* c = C.data();
-
-  matmul(a, b, c, N, N);
-  return C;
-}
-
-void validate_result(std::vector<int>& C, int N) {
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-  int* c = C.data();
-  for (int i = 0; i < N; i++) {
-    for (int j = 0; j < N; j++) {
-      auto res = c[i * N + j];
-      if (res != N) {
-        std::printf(
-          "Wrong result at (%d,%d) : %d. expected %d\n", i, j, res, N
-        );
-        std::fflush(stdout);
-        std::terminate();
-      }
-    }
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  matmul(M.tile(), M.N);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
   }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
 }
 
-void run_one(int N) {
-  auto startTime = std::chrono::high_resolution_clock::now();
-  std::vector<int> result = run_matmul(N);
-  auto endTime = std::chrono::high_resolution_clock::now();
-  validate_result(result, N);
-  auto totalTimeUs =
-    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+template <typename T> void run_one(int N) {
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(m, &cpu);
+  m.validate();
   std::printf("  - matrix_size: %d\n", N);
-  std::printf("    duration: %zu us\n", totalTimeUs.count());
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -107,11 +96,16 @@ int hpx_main(hpx::program_options::variables_map&) {
     hpx::threads::policies::scheduler_mode::steal_after_local
   );
 
-  run_matmul(matmul_n); // warmup
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(warmup);
+    }
 
-  std::printf("runs:\n");
+    std::printf("runs:\n");
 
-  run_one(matmul_n);
+    run_one<T>(args.n);
+  });
 
   return hpx::local::finalize();
 }
@@ -121,10 +115,11 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
   }
   if (argc < 2) {
-    printf("Usage: matmul <matrix size (power of 2)>\n");
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
     exit(0);
   }
-  matmul_n = atoi(argv[1]);
+  // The config selects the base case kernel and the element type.
+  args = matmul_parse_args(argc, argv);
   std::printf("threads: %zu\n", thread_count);
 
   // Force HPX to use the most efficient (?) queue mode
@@ -11,7 +11,9 @@
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "hpx/async_combinators/when_all.hpp"
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 #include <hpx/config.hpp>
 #include <hpx/experimental/task_group.hpp>
 #include <hpx/future.hpp>
@@ -46,8 +48,8 @@ void check_answer(int result) {
 // and completes in 34663728 us on my EPYC server.
 template <size_t N>
 hpx::future<int> nqueens(int xMax, std::array<char, N> buf) {
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   auto ys = std::ranges::views::iota(0UL, N) |
@@ -138,6 +140,7 @@ int hpx_main(hpx::program_options::variables_map& vm) {
     check_answer(result);
   }
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -148,11 +151,13 @@ int hpx_main(hpx::program_options::variables_map& vm) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 
   return hpx::local::finalize();
@@ -0,0 +1,133 @@
+// Test the cost of racing tasks and abandoning the losers.
+// Each race starts K tasks of random cost and takes the first result. Reports
+// the latency to the first result, and the share of work spent on losers
+// before they stopped.
+// The workload is defined in 2common/when_any.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "hpx/async_combinators/when_all.hpp"
+#include "hpx/async_combinators/when_any.hpp"
+#include "memusage.hpp"
+#include "when_any.hpp"
+#include <hpx/future.hpp>
+#include <hpx/init.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 8;
+
+// when_any resumes the awaiter as soon as one future is ready, but the losers
+// keep running. HPX has no task cancellation, so they are stopped with the
+// race's flag and then drained.
+static hpx::future<void> race_one(size_t Race, when_any_stats& Stats) {
+  when_any_race race(Race, task_count);
+  std::vector<hpx::future<size_t>> futures;
+  futures.reserve(task_count);
+  for (size_t i = 0; i < task_count; ++i) {
+    futures.push_back(hpx::async([&race, i]() { return race.run(i); }));
+  }
+  auto any = co_await hpx::when_any(std::move(futures));
+  size_t winner = any.futures[any.index].get();
+  race.done.store(true, std::memory_order_relaxed);
+  Stats.record_first(race);
+  co_await hpx::when_all(any.futures);
+  Stats.record_done(race, winner);
+}
+
+static void run_races(when_any_stats& Stats) {
+  for (size_t i = 0; i < when_any_race_count; ++i) {
+    race_one(i, Stats).get();
+  }
+}
+
+int hpx_main(hpx::program_options::variables_map&) {
+  hpx::threads::set_scheduler_mode(
+    hpx::threads::policies::scheduler_mode::enable_stealing |
+    hpx::threads::policies::scheduler_mode::enable_stealing_numa |
+    hpx::threads::policies::scheduler_mode::assign_work_thread_parent |
+    hpx::threads::policies::scheduler_mode::steal_after_local
+  );
+
+  {
+    when_any_stats stats;
+    run_races(stats); // warmup
+  }
+
+  when_any_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+  run_races(stats);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  if (stats.wrong_results != 0) {
+    std::printf(
+      "FAIL: %zu of %zu races had no valid winner\n", stats.wrong_results,
+      when_any_race_count
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    races: %zu\n", when_any_race_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    races/sec: %zu\n",
+    static_cast<size_t>(when_any_race_count * 1000000 / totalTimeUs)
+  );
+  std::printf("    first_p50: %zu us\n", stats.first.percentile_us(50.0));
+  std::printf("    first_p99: %zu us\n", stats.first.percentile_us(99.0));
+  std::printf("    loser_work_pct: %zu\n", stats.loser_work_pct());
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+
+  return hpx::local::finalize();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+
+  hpx::local::init_params init_args;
+  init_args.cfg = {
+    "hpx.os_threads=" + std::to_string(thread_count),
+    "hpx.stacks.small_size=0x4000", "hpx.stacks.use_guard_pages=0"
+  };
+
+  return hpx::local::init(hpx_main, argc, argv, init_args);
+}
@@ -0,0 +1,132 @@
+// Test the impact of blocking calls made from tasks.
+// A fraction of otherwise CPU-bound tasks make a blocking call. The call is
+// either made in place on the worker thread, or offloaded using the library's
+// mechanism for blocking work. Reports the task throughput.
+// The workload is defined in 2common/blocking.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "blocking.hpp"
+#include "memusage.hpp"
+#include "tmc/ex_cpu.hpp"
+#include "tmc/spawn.hpp"
+#include "tmc/spawn_many.hpp"
+#include "tmc/sync.hpp"
+#include "tmc/task.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t pct = 1;
+
+// A second executor whose threads are dedicated to blocking calls.
+static tmc::ex_cpu blocking_executor;
+
+static tmc::task<void> blocking_call_task() {
+  blocking_call();
+  co_return;
+}
+
+// When offloading, the blocking call runs on blocking_executor and this task
+// resumes on the cpu_executor afterward. This frees the worker thread to run
+// other tasks in the meantime.
+static tmc::task<void>
+run_task(size_t Index, bool Offload, std::vector<uint64_t>& Results) {
+  if (blocking_is_blocking(Index, pct)) {
+    if (Offload) {
+      co_await tmc::spawn(blocking_call_task()).run_on(blocking_executor);
+    } else {
+      blocking_call();
+    }
+  }
+  Results[Index] = blocking_cpu_work(Index);
+}
+
+static tmc::task<void> run_all(bool Offload, std::vector<uint64_t>& Results) {
+  std::vector<tmc::task<void>> tasks(blocking_task_count);
+  for (size_t i = 0; i < blocking_task_count; ++i) {
+    tasks[i] = run_task(i, Offload, Results);
+  }
+  co_await tmc::spawn_many(tasks.data(), blocking_task_count);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    pct = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  bool offload = argc > 3 && strcmp(argv[3], "offload") == 0;
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("blocking_pct: %zu\n", pct);
+  tmc::cpu_executor()
+    .set_thread_count(thread_count)
+    .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
+    .init();
+  if (offload) {
+    blocking_executor.set_thread_count(blocking_offload_threads).init();
+  }
+  uint64_t expected = blocking_expected_checksum();
+
+  std::vector<uint64_t> results(blocking_task_count);
+  tmc::post_waitable(tmc::cpu_executor(), run_all(offload, results))
+    .wait(); // warmup
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  tmc::post_waitable(tmc::cpu_executor(), run_all(offload, results)).wait();
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  uint64_t sum = 0;
+  for (uint64_t r : results) {
+    sum += r;
+  }
+  if (sum != expected) {
+    std::printf(
+      "FAIL: expected checksum %" PRIu64 " but got %" PRIu64 "\n", expected, sum
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    tasks: %zu\n", blocking_task_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    tasks/sec: %zu\n",
+    static_cast<size_t>(blocking_task_count * 1000000 / totalTimeUs)
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
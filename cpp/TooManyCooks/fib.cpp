@@ -26,13 +26,17 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "tmc/all_headers.hpp"
+#include "two_pools.hpp"
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
@@ -42,8 +46,8 @@ static const size_t iter_count = 1;
 // It has better performance than the tuple variant (by using separate
 // synchronization variables) but uses more memory for the same reason.
 static tmc::task<size_t> fib(size_t n) {
-  if (n < 2)
-    co_return n;
+  if (n < fib_cutoff)
+    co_return fib_serial(n);
 
   auto x_hot = spawn(fib(n - 1)).fork();
   auto y = co_await fib(n - 2);
@@ -58,6 +62,29 @@ static tmc::task<size_t> fib(size_t n) {
   //   co_return x + y;
 }
 
+// Runs fib(n) on two executors at once, each with half of the threads.
+// Pinning is disabled so that the OS splits the cores between the two pools.
+static void run_two_pools(size_t n) {
+  tmc::ex_cpu executors[2];
+  size_t results[2];
+  for (size_t i = 0; i < 2; ++i) {
+    executors[i]
+      .set_thread_count(two_pools_threads(thread_count, i))
+      .set_thread_pinning_level(tmc::topology::thread_pinning_level::NONE)
+      .init();
+    results[i] = tmc::post_waitable(executors[i], fib(30)).get(); // warmup
+  }
+
+  auto result = two_pools_run([&](size_t Pool) {
+    results[Pool] = tmc::post_waitable(executors[Pool], fib(n)).get();
+  });
+  std::printf("output: %zu %zu\n", results[0], results[1]);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  result.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
 int main(int argc, char* argv[]) {
   if (argc > 2) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
@@ -69,6 +96,10 @@ int main(int argc, char* argv[]) {
   size_t n = static_cast<size_t>(atoi(argv[1]));
 
   std::printf("threads: %" PRIu64 "\n", thread_count);
+  if (argc > 3 && strcmp(argv[3], "2pool") == 0) {
+    run_two_pools(n);
+    return 0;
+  }
   tmc::cpu_executor()
     .set_thread_count(thread_count)
     .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
@@ -77,6 +108,7 @@ int main(int argc, char* argv[]) {
   return tmc::async_main([](size_t N) -> tmc::task<int> {
     auto result = co_await fib(30); // warmup
 
+    auto startCpu = utilization_now();
     auto startTime = std::chrono::high_resolution_clock::now();
 
     for (size_t i = 0; i < iter_count; ++i) {
@@ -85,12 +117,14 @@ int main(int argc, char* argv[]) {
     }
 
     auto endTime = std::chrono::high_resolution_clock::now();
+    auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
     auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
       endTime - startTime
     );
     std::printf("runs:\n");
     std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
     std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+    cpu.print_yaml();
     std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
     co_return 0;
   }(n));
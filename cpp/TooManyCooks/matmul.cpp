@@ -9,80 +9,101 @@
 
 #include "matmul.hpp"
 #include "memusage.hpp"
+#include "numa.hpp"
 #include "tmc/all_headers.hpp"
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
-#include <exception>
-#include <vector>
+#include <optional>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 
-tmc::task<void> matmul(int* a, int* b, int* c, int n, int N) {
-  if (n <= 32) {
+// Set during the timed run of the "firsttouch" config.
+static numa_leaf_log* numa_log = nullptr;
+
+template <typename T> tmc::task<void> matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
     // Base case: Use simple triple-loop multiplication for small matrices
-    matmul_small(a, b, c, n, N);
+    matmul_small(t, N);
+    if (numa_log != nullptr) {
+      numa_log->record(t.c);
+    }
   } else {
     // Recursive case: Divide the matrices into 4 submatrices and multiply them
-    int k = n / 2;
+    auto s = matmul_split(t, N);
 
     // Split the execution into 2 sections to ensure output locations are not
     // written in parallel
     co_await tmc::spawn_tuple(
-      matmul(a, b, c, k, N), matmul(a, b + k, c + k, k, N),
-      matmul(a + k * N, b, c + k * N, k, N),
-      matmul(a + k * N, b + k, c + k * N + k, k, N)
+      matmul(s[0], N), matmul(s[1], N), matmul(s[2], N), matmul(s[3], N)
     );
 
     co_await tmc::spawn_tuple(
-      matmul(a + k, b + k * N, c, k, N),
-      matmul(a + k, b + k * N + k, c + k, k, N),
-      matmul(a + k * N + k, b + k * N, c + k * N, k, N),
-      matmul(a + k * N + k, b + k * N + k, c + k * N + k, k, N)
+      matmul(s[4], N), matmul(s[5], N), matmul(s[6], N), matmul(s[7], N)
     );
   }
 }
 
-std::vector<int> run_matmul(int N) {
-  std::vector<int> A(N * N, 1);
-  std::vector<int> B(N * N, 1);
-  std::vector<int> C(N * N, 0);
-
-  int* a = A.data();
-  int* b = B.data();
-  int* c = C.data();
-
-  tmc::post_waitable(tmc::cpu_executor(), matmul(a, b, c, N, N)).get();
-  return C;
+// Initializes the matrices with the same recursive split as matmul, so that
+// each page is first touched by a worker rather than the main thread.
+template <typename T>
+tmc::task<void> matmul_init(matmul_matrices<T>& M, matmul_tile<T> t) {
+  if (matmul_is_leaf(t)) {
+    M.init(t);
+  } else {
+    auto s = matmul_split(t, M.N);
+    co_await tmc::spawn_tuple(
+      matmul_init(M, s[0]), matmul_init(M, s[1]), matmul_init(M, s[2]),
+      matmul_init(M, s[3])
+    );
+  }
 }
 
-void validate_result(std::vector<int>& C, int N) {
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-  int* c = C.data();
-  for (int i = 0; i < N; i++) {
-    for (int j = 0; j < N; j++) {
-      auto res = c[i * N + j];
-      if (res != N) {
-        std::printf(
-          "Wrong result at (%d,%d) : %d. expected %d\n", i, j, res, N
-        );
-        std::fflush(stdout);
-        std::terminate();
-      }
-    }
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  matmul_matrices<T>& M, bool FirstTouch, utilization_result* Cpu = nullptr
+) {
+  if (FirstTouch) {
+    tmc::post_waitable(tmc::cpu_executor(), matmul_init(M, M.tile())).get();
+  } else {
+    M.init();
   }
-}
 
-void run_one(int N) {
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
-  std::vector<int> result = run_matmul(N);
+  tmc::post_waitable(tmc::cpu_executor(), matmul(M.tile(), M.N)).get();
   auto endTime = std::chrono::high_resolution_clock::now();
-  validate_result(result, N);
-  auto totalTimeUs =
-    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
+}
+
+template <typename T> void run_one(int N, bool FirstTouch) {
+  matmul_matrices<T> m(N);
+  // The log holds an entry per leaf, so only allocate it when it is used.
+  std::optional<numa_leaf_log> log;
+  if (FirstTouch) {
+    log.emplace(matmul_leaf_count(N));
+    numa_log = &*log;
+  }
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(m, FirstTouch, &cpu);
+  numa_log = nullptr;
+  m.validate();
   std::printf("  - matrix_size: %d\n", N);
-  std::printf("    duration: %zu us\n", totalTimeUs.count());
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  if (FirstTouch) {
+    log->print_yaml(m.c.get(), sizeof(T) * m.elements());
+  }
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -91,19 +112,27 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
   }
   if (argc < 2) {
-    printf("Usage: matmul <matrix size (power of 2)>\n");
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
     exit(0);
   }
-  int n = atoi(argv[1]);
+  // The config selects the base case kernel and the element type. The
+  // "firsttouch" config initializes the matrices in parallel on the workers
+  // and reports the NUMA locality of the leaf tasks.
+  matmul_args args = matmul_parse_args(argc, argv);
   std::printf("threads: %zu\n", thread_count);
   tmc::cpu_executor()
     .set_thread_count(thread_count)
     .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
     .init();
 
-  run_matmul(n); // warmup
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(warmup, args.first_touch);
+    }
 
-  std::printf("runs:\n");
+    std::printf("runs:\n");
 
-  run_one(n);
+    run_one<T>(args.n, args.first_touch);
+  });
 }
@@ -10,10 +10,12 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "tmc/ex_cpu.hpp"
 #include "tmc/spawn_many.hpp"
 #include "tmc/task.hpp"
+#include "utilization.hpp"
 #include <array>
 #include <cinttypes>
 #include <cstdio>
@@ -38,8 +40,8 @@ void check_answer(int result) {
 }
 
 template <size_t N> tmc::task<int> nqueens(int xMax, std::array<char, N> buf) {
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   size_t taskCount = 0;
@@ -90,6 +92,7 @@ int main(int argc, char* argv[]) {
       check_answer(result);
     }
 
+    auto startCpu = utilization_now();
     auto startTime = std::chrono::high_resolution_clock::now();
 
     for (size_t i = 0; i < iter_count; ++i) {
@@ -100,12 +103,14 @@ int main(int argc, char* argv[]) {
     }
 
     auto endTime = std::chrono::high_resolution_clock::now();
+    auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
     auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
       endTime - startTime
     );
     std::printf("runs:\n");
     std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
     std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+    cpu.print_yaml();
     std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
     co_return 0;
   }());
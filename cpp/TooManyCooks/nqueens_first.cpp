@@ -0,0 +1,127 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Find-first variant: stops all outstanding work once the single matching
+// solution defined in 2common/nqueens_first.hpp is found.
+
+#include "memusage.hpp"
+#include "nqueens_first.hpp"
+#include "tmc/ex_cpu.hpp"
+#include "tmc/spawn_many.hpp"
+#include "tmc/task.hpp"
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <ranges>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+// TMC has no task cancellation, so this uses a shared flag. Tasks that have
+// already been spawned still run, but return immediately.
+template <size_t N>
+tmc::task<void>
+nqueens_first(int xMax, std::array<char, N> buf, nqueens_first_state& State) {
+  if (State.found()) {
+    co_return;
+  }
+  if (N == xMax) {
+    uint64_t hash = nqueens_first_hash(buf);
+    if (nqueens_first_match(hash)) {
+      State.publish(hash);
+    }
+    co_return;
+  }
+
+  auto tasks =
+    std::ranges::views::iota(0UL, N) |
+    std::ranges::views::filter([xMax, &buf](int y) {
+      char q = y;
+      for (int x = 0; x < xMax; x++) {
+        char p = buf[x];
+        if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+          return false;
+        }
+      }
+      return true;
+    }) |
+    std::ranges::views::transform([xMax, &buf, &State](int y) {
+      buf[xMax] = y;
+      return nqueens_first(xMax + 1, buf, State);
+    });
+
+  co_await tmc::spawn_many<N>(tasks.begin(), tasks.end());
+}
+
+static void check_answer(const nqueens_first_state& State) {
+  if (!State.found() || State.answer != nqueens_first_answer) {
+    std::printf(
+      "FAIL: expected %" PRIu64 ", got %" PRIu64 "\n", nqueens_first_answer,
+      State.answer
+    );
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  tmc::cpu_executor()
+    .set_thread_count(thread_count)
+    .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
+    .init();
+
+  return tmc::async_main([]() -> tmc::task<int> {
+    {
+      nqueens_first_state state;
+      std::array<char, nqueens_first_work> buf{};
+      co_await nqueens_first(0, buf, state); // warmup
+      check_answer(state);
+    }
+
+    size_t answerUs = 0;
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < iter_count; ++i) {
+      nqueens_first_state state;
+      std::array<char, nqueens_first_work> buf{};
+      auto iterStart = std::chrono::steady_clock::now();
+      co_await nqueens_first(0, buf, state);
+      check_answer(state);
+      answerUs += static_cast<size_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          state.found_at - iterStart
+        )
+          .count()
+      );
+      std::printf("output: %" PRIu64 "\n", state.answer);
+    }
+
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto totalTimeUs = static_cast<size_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        endTime - startTime
+      )
+        .count()
+    );
+    std::printf("runs:\n");
+    std::printf("  - iteration_count: %zu\n", iter_count);
+    std::printf("    duration: %zu us\n", totalTimeUs);
+    std::printf("    time_to_answer: %zu us\n", answerUs);
+    std::printf("    drain: %zu us\n", totalTimeUs - answerUs);
+    std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+    co_return 0;
+  }());
+}
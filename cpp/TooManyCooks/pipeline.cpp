@@ -0,0 +1,158 @@
+// Test performance of a producer-consumer pipeline with multiple CPU-bound
+// stages and a bounded number of items in flight.
+// The workload is defined in 2common/pipeline.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "pipeline.hpp"
+#include "tmc/channel.hpp"
+#include "tmc/ex_cpu.hpp"
+#include "tmc/semaphore.hpp"
+#include "tmc/spawn.hpp"
+#include "tmc/spawn_many.hpp"
+#include "tmc/sync.hpp"
+#include "tmc/task.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+using token = tmc::chan_tok<pipeline_item>;
+
+// TMC has no pipeline construct, so the stages are connected by channels.
+// The number of items in flight is bounded by a semaphore which the source
+// acquires and the sink releases.
+static tmc::task<void> source(token out, tmc::semaphore& tokens) {
+  for (size_t i = 0; i < pipeline_item_count; ++i) {
+    co_await tokens;
+    out.post(pipeline_make_item(i));
+  }
+  co_await out.drain();
+}
+
+static tmc::task<void> stage_worker(token in, token out, size_t stage) {
+  while (auto data = co_await in.pull()) {
+    auto& item = data.value();
+    item.value = pipeline_stage_work(item.value, stage);
+    out.post(item);
+  }
+}
+
+static tmc::task<void> parallel_stage(token in, token out, size_t stage) {
+  std::vector<tmc::task<void>> workers(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers[i] = stage_worker(in, out, stage);
+  }
+  co_await tmc::spawn_many(workers);
+  co_await out.drain();
+}
+
+static tmc::task<void>
+sink(token in, tmc::semaphore& tokens, pipeline_stats& stats) {
+  while (auto data = co_await in.pull()) {
+    stats.record(data.value());
+    tokens.release();
+  }
+}
+
+static tmc::task<void> do_bench(pipeline_stats& stats) {
+  tmc::semaphore tokens(pipeline_token_count(thread_count));
+  std::vector<token> chans;
+  for (size_t i = 0; i < pipeline_stage_count - 1; ++i) {
+    chans.push_back(tmc::make_channel<pipeline_item>());
+  }
+
+  auto s = tmc::spawn(sink(chans.back(), tokens, stats)).fork();
+  std::vector<tmc::task<void>> stages;
+  stages.push_back(source(chans[0], tokens));
+  for (size_t stage = 1; stage < pipeline_stage_count - 1; ++stage) {
+    stages.push_back(parallel_stage(chans[stage - 1], chans[stage], stage));
+  }
+  co_await tmc::spawn_many(stages);
+  co_await std::move(s);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("stages: %zu\n", pipeline_stage_count);
+  std::printf("tokens: %zu\n", pipeline_token_count(thread_count));
+  uint64_t expected = pipeline_expected_checksum();
+  tmc::cpu_executor()
+    .set_thread_count(thread_count)
+    .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
+    .init();
+
+  {
+    pipeline_stats stats;
+    tmc::post_waitable(tmc::cpu_executor(), do_bench(stats)).get(); // warmup
+  }
+
+  pipeline_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    tmc::post_waitable(tmc::cpu_executor(), do_bench(stats)).get();
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  if (stats.count != pipeline_item_count * iter_count ||
+      stats.checksum != expected * iter_count) {
+    std::printf(
+      "FAIL: Expected %zu items with checksum %" PRIu64
+      " but got %zu items with checksum %" PRIu64 "\n",
+      pipeline_item_count * iter_count, expected * iter_count, stats.count,
+      stats.checksum
+    );
+  }
+
+  size_t itemsPerSec = static_cast<size_t>(
+    static_cast<double>(stats.count) * 1000000.0 /
+    static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    items: %zu\n", stats.count);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    items/sec: %zu\n", itemsPerSec);
+  std::printf("    latency_p50: %zu us\n", stats.latency_us(50.0));
+  std::printf("    latency_p99: %zu us\n", stats.latency_us(99.0));
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -0,0 +1,148 @@
+// Test priority scheduling under a saturating background load.
+// Repeated skynet trees run at low priority while an external thread injects
+// probe tasks at high priority. Reports probe latency percentiles and the
+// background throughput in trees/sec.
+// Pass "same" as the config argument to run the probes at the same priority
+// as the background load, for comparison.
+// The workload is defined in 2common/priority.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "priority.hpp"
+#include "tmc/ex_cpu.hpp"
+#include "tmc/spawn_many.hpp"
+#include "tmc/sync.hpp"
+#include "tmc/task.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ranges>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+
+// Probes always run at priority 0 (highest). The background load runs at the
+// lowest priority that this build supports.
+static size_t background_priority = TMC_PRIORITY_COUNT - 1;
+
+template <size_t DepthMax>
+tmc::task<size_t> skynet_one(size_t BaseNum, size_t Depth) {
+  if (Depth == DepthMax) {
+    co_return BaseNum;
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
+    depthOffset *= 10;
+  }
+
+  // Child tasks inherit the priority of their parent.
+  std::array<size_t, 10> results = co_await tmc::spawn_many<10>(
+    (
+      std::ranges::views::iota(0UL) |
+      std::ranges::views::transform([=](size_t idx) {
+        return skynet_one<DepthMax>(BaseNum + depthOffset * idx, Depth + 1);
+      })
+    ).begin()
+  );
+
+  size_t count = 0;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    count += results[idx];
+  }
+  co_return count;
+}
+
+static tmc::task<void> background_loop(priority_background& Bg) {
+  while (!Bg.stop.load(std::memory_order_relaxed)) {
+    Bg.record(co_await skynet_one<priority_background_depth>(0, 0));
+  }
+}
+
+static tmc::task<void> probe(priority_probes& Probes, size_t Index) {
+  Probes.record(Index);
+  co_return;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2 && strcmp(argv[2], "same") == 0) {
+    background_priority = 0;
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("priority_count: %d\n", TMC_PRIORITY_COUNT);
+  tmc::cpu_executor()
+    .set_thread_count(thread_count)
+    .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
+    .init();
+
+  priority_background bg;
+  auto bgFuture = tmc::post_waitable(
+    tmc::cpu_executor(), background_loop(bg), background_priority
+  );
+  // Let the background load ramp up before injecting probes.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  priority_probes probes;
+  size_t startTrees = bg.trees.load();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  probes.run([&](size_t Index) {
+    tmc::post(tmc::cpu_executor(), probe(probes, Index), 0);
+  });
+  auto endTime = std::chrono::high_resolution_clock::now();
+  size_t trees = bg.trees.load() - startTrees;
+  bg.stop.store(true);
+  bgFuture.wait();
+
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+  if (bg.wrong_results.load() != 0) {
+    std::printf("FAIL: background skynet returned the wrong result\n");
+  }
+  auto latency = probes.histogram();
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    probes: %zu\n", priority_probe_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    trees/sec: %zu\n",
+    static_cast<size_t>(trees * 1000000 / totalTimeUs)
+  );
+  std::printf("    probe_p50: %zu us\n", latency.percentile_us(50.0));
+  std::printf("    probe_p99: %zu us\n", latency.percentile_us(99.0));
+  std::printf("    probe_p999: %zu us\n", latency.percentile_us(99.9));
+  std::printf(
+    "    probe_max: %zu us\n", static_cast<size_t>(latency.max_ns / 1000)
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
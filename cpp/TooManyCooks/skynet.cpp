@@ -28,15 +28,20 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "tmc/sync.hpp"
 #include "tmc/ex_cpu.hpp"
 #include "tmc/spawn_many.hpp"
 #include "tmc/task.hpp"
+#include "two_pools.hpp"
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ranges>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
@@ -44,8 +49,8 @@ static const size_t iter_count = 1;
 
 template <size_t DepthMax>
 tmc::task<size_t> skynet_one(size_t BaseNum, size_t Depth) {
-  if (Depth == DepthMax) {
-    co_return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    co_return skynet_serial(BaseNum, DepthMax - Depth);
   }
   size_t depthOffset = 1;
   for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
@@ -86,15 +91,40 @@ template <size_t DepthMax> tmc::task<void> skynet() {
 
 template <size_t Depth = 6> tmc::task<void> loop_skynet() {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     co_await skynet<Depth>();
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+// Runs skynet on two executors at once, each with half of the threads.
+// Pinning is disabled so that the OS splits the cores between the two pools.
+template <size_t Depth = 6> void run_two_pools() {
+  tmc::ex_cpu executors[2];
+  for (size_t i = 0; i < 2; ++i) {
+    executors[i]
+      .set_thread_count(two_pools_threads(thread_count, i))
+      .set_thread_pinning_level(tmc::topology::thread_pinning_level::NONE)
+      .set_work_stealing_strategy(tmc::work_stealing_strategy::LATTICE_MATRIX)
+      .init();
+    tmc::post_waitable(executors[i], skynet<Depth>()).wait(); // warmup
+  }
+
+  auto result = two_pools_run([&](size_t Pool) {
+    tmc::post_waitable(executors[Pool], skynet<Depth>()).wait();
+  });
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  result.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -103,6 +133,10 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[1]));
   }
   std::printf("threads: %" PRIu64 "\n", thread_count);
+  if (argc > 2 && strcmp(argv[2], "2pool") == 0) {
+    run_two_pools<8>();
+    return 0;
+  }
   tmc::cpu_executor()
     .set_thread_count(thread_count)
     .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
@@ -0,0 +1,259 @@
+// Test performance of the async synchronization primitives under contention.
+// A configurable number of tasks hammer a single primitive; the task count is
+// the contention level. Supported primitives: mutex, semaphore, barrier, latch,
+// event
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "tmc/barrier.hpp"
+#include "tmc/ex_cpu.hpp"
+#include "tmc/latch.hpp"
+#include "tmc/manual_reset_event.hpp"
+#include "tmc/mutex.hpp"
+#include "tmc/semaphore.hpp"
+#include "tmc/spawn_many.hpp"
+#include "tmc/sync.hpp"
+#include "tmc/task.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 16;
+static std::string primitive = "mutex";
+static const size_t iter_count = 1;
+
+static constexpr size_t op_count = 10000000;
+
+// The number of tasks that may hold the semaphore at once.
+static constexpr size_t semaphore_permits = 4;
+
+// A latch can't be reused, so each round gets its own. The rounds are capped
+// to bound the memory used by the latches.
+static constexpr size_t latch_max_rounds = 100000;
+
+// Only accessed while holding the mutex.
+static size_t mutex_counter;
+
+static std::atomic<size_t> ops_done;
+static std::atomic<size_t> holders;
+static std::atomic<size_t> max_holders;
+static std::atomic<size_t> arrived;
+
+static tmc::task<void> mutex_worker(tmc::mutex& mtx, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    co_await mtx;
+    ++mutex_counter;
+    mtx.unlock();
+  }
+}
+
+static tmc::task<void> semaphore_worker(tmc::semaphore& sem, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    co_await sem;
+    size_t h = holders.fetch_add(1, std::memory_order_relaxed) + 1;
+    size_t m = max_holders.load(std::memory_order_relaxed);
+    while (h > m && !max_holders.compare_exchange_weak(
+                      m, h, std::memory_order_relaxed
+                    )) {
+    }
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    holders.fetch_sub(1, std::memory_order_relaxed);
+    sem.release();
+  }
+}
+
+static tmc::task<void> barrier_worker(tmc::barrier& bar, size_t rounds) {
+  for (size_t i = 0; i < rounds; ++i) {
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    co_await bar;
+  }
+}
+
+static tmc::task<void> latch_worker(std::deque<tmc::latch>& latches) {
+  for (auto& l : latches) {
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    l.count_down();
+    co_await l;
+  }
+}
+
+// The manual-reset events alternate between rounds. The last task to arrive
+// at a round resets the other event and then sets this round's event. No task
+// is still waiting on the event being reset, since every task has already
+// arrived at this round.
+static tmc::task<void>
+event_worker(tmc::manual_reset_event (&events)[2], size_t rounds) {
+  for (size_t i = 0; i < rounds; ++i) {
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == task_count) {
+      arrived.store(0, std::memory_order_relaxed);
+      events[(i + 1) % 2].reset();
+      events[i % 2].set();
+    }
+    co_await events[i % 2];
+  }
+}
+
+// Returns the number of operations performed.
+static tmc::task<size_t> do_bench() {
+  mutex_counter = 0;
+  ops_done = 0;
+  holders = 0;
+  max_holders = 0;
+  arrived = 0;
+
+  size_t per_task = op_count / task_count;
+  size_t rem = op_count % task_count;
+  std::vector<tmc::task<void>> tasks(task_count);
+
+  if (primitive == "mutex") {
+    tmc::mutex mtx;
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks[i] = mutex_worker(mtx, i < rem ? per_task + 1 : per_task);
+    }
+    co_await tmc::spawn_many(tasks);
+    if (mutex_counter != op_count) {
+      std::printf(
+        "FAIL: Expected %zu increments but got %zu\n", op_count, mutex_counter
+      );
+    }
+    co_return mutex_counter;
+  } else if (primitive == "semaphore") {
+    tmc::semaphore sem(semaphore_permits);
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks[i] = semaphore_worker(sem, i < rem ? per_task + 1 : per_task);
+    }
+    co_await tmc::spawn_many(tasks);
+    if (max_holders > semaphore_permits) {
+      std::printf(
+        "FAIL: %zu tasks held the semaphore at once (max %zu)\n",
+        max_holders.load(), semaphore_permits
+      );
+    }
+  } else if (primitive == "latch") {
+    std::deque<tmc::latch> latches;
+    size_t rounds = per_task < latch_max_rounds ? per_task : latch_max_rounds;
+    for (size_t i = 0; i < rounds; ++i) {
+      latches.emplace_back(task_count);
+    }
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks[i] = latch_worker(latches);
+    }
+    co_await tmc::spawn_many(tasks);
+    if (ops_done != rounds * task_count) {
+      std::printf(
+        "FAIL: Expected %zu arrivals but got %zu\n", rounds * task_count,
+        ops_done.load()
+      );
+    }
+  } else {
+    // Every task must arrive at each phase, so all tasks run the same number
+    // of rounds and the remainder is dropped.
+    tmc::barrier bar(task_count);
+    tmc::manual_reset_event events[2];
+    for (size_t i = 0; i < task_count; ++i) {
+      if (primitive == "barrier") {
+        tasks[i] = barrier_worker(bar, per_task);
+      } else {
+        tasks[i] = event_worker(events, per_task);
+      }
+    }
+    co_await tmc::spawn_many(tasks);
+    if (ops_done != per_task * task_count) {
+      std::printf(
+        "FAIL: Expected %zu arrivals but got %zu\n", per_task * task_count,
+        ops_done.load()
+      );
+    }
+  }
+  co_return ops_done.load();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+    if (task_count == 0) {
+      task_count = 1;
+    }
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc > 3) {
+    primitive = argv[3];
+  }
+  if (primitive != "mutex" && primitive != "semaphore" &&
+      primitive != "barrier" && primitive != "latch" && primitive != "event") {
+    std::printf("Unknown primitive: %s\n", primitive.c_str());
+    std::printf("Usage: sync <task count> [thread count] "
+                "[mutex|semaphore|barrier|latch|event]\n");
+    exit(1);
+  }
+
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+  std::printf("primitive: %s\n", primitive.c_str());
+  tmc::cpu_executor()
+    .set_thread_count(thread_count)
+    .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
+    .init();
+
+  {
+    auto result = tmc::post_waitable(tmc::cpu_executor(), do_bench()).get();
+    std::printf("output: %zu\n", result); // warmup
+  }
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  size_t ops = 0;
+  for (size_t i = 0; i < iter_count; ++i) {
+    ops += tmc::post_waitable(tmc::cpu_executor(), do_bench()).get();
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  size_t opsPerSec = static_cast<size_t>(
+    static_cast<double>(ops) * 1000000.0 / static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    operations: %zu\n", ops);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    operations/sec: %zu\n", opsPerSec);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
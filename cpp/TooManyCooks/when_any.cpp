@@ -0,0 +1,129 @@
+// Test the cost of racing tasks and abandoning the losers.
+// Each race starts K tasks of random cost and takes the first result. Reports
+// the latency to the first result, and the share of work spent on losers
+// before they stopped.
+// The workload is defined in 2common/when_any.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "tmc/ex_cpu.hpp"
+#include "tmc/spawn_many.hpp"
+#include "tmc/task.hpp"
+#include "when_any.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 8;
+
+static tmc::task<size_t> racer(when_any_race& Race, size_t Index) {
+  co_return Race.run(Index);
+}
+
+// result_each() resumes the awaiter as each task completes, so the winner is
+// known as soon as the first task finishes. TMC has no task cancellation, so
+// the losers are stopped with the race's flag and then drained.
+static tmc::task<void> race_one(size_t Race, when_any_stats& Stats) {
+  when_any_race race(Race, task_count);
+  std::vector<tmc::task<size_t>> tasks(task_count);
+  for (size_t i = 0; i < task_count; ++i) {
+    tasks[i] = racer(race, i);
+  }
+  size_t winner = SIZE_MAX;
+  auto each = tmc::spawn_many(tasks.data(), task_count).result_each();
+  for (auto idx = co_await each; idx != each.end(); idx = co_await each) {
+    if (winner == SIZE_MAX && race.units[idx] == race.cost[idx]) {
+      winner = idx;
+      race.done.store(true, std::memory_order_relaxed);
+      Stats.record_first(race);
+    }
+  }
+  Stats.record_done(race, winner);
+}
+
+static tmc::task<void> run_races(when_any_stats& Stats) {
+  for (size_t i = 0; i < when_any_race_count; ++i) {
+    co_await race_one(i, Stats);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+  tmc::cpu_executor()
+    .set_thread_count(thread_count)
+    .set_thread_pinning_level(tmc::topology::thread_pinning_level::CORE)
+    .init();
+
+  return tmc::async_main([]() -> tmc::task<int> {
+    {
+      when_any_stats stats;
+      co_await run_races(stats); // warmup
+    }
+
+    when_any_stats stats;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    co_await run_races(stats);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto totalTimeUs = static_cast<size_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        endTime - startTime
+      )
+        .count()
+    );
+
+    if (stats.wrong_results != 0) {
+      std::printf(
+        "FAIL: %zu of %zu races had no valid winner\n", stats.wrong_results,
+        when_any_race_count
+      );
+    }
+    std::printf("runs:\n");
+    std::printf("  - iteration_count: 1\n");
+    std::printf("    races: %zu\n", when_any_race_count);
+    std::printf("    duration: %zu us\n", totalTimeUs);
+    std::printf(
+      "    races/sec: %zu\n",
+      static_cast<size_t>(when_any_race_count * 1000000 / totalTimeUs)
+    );
+    std::printf("    first_p50: %zu us\n", stats.first.percentile_us(50.0));
+    std::printf("    first_p99: %zu us\n", stats.first.percentile_us(99.0));
+    std::printf("    loser_work_pct: %zu\n", stats.loser_work_pct());
+    std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+    co_return 0;
+  }());
+}
@@ -1,8 +1,10 @@
 // Port of cpp/libfork/fib.cpp using citor::forkJoin.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "citor/thread_pool.h"
 #include "citor/hints.h"
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cinttypes>
@@ -14,8 +16,8 @@ static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 
 size_t fibonacci(citor::ThreadPool& pool, size_t n) {
-  if (n < 2) {
-    return n;
+  if (n < fib_cutoff) {
+    return fib_serial(n);
   }
   size_t x = 0;
   size_t y = 0;
@@ -49,6 +51,7 @@ int main(int argc, char* argv[]) {
   size_t result = fibonacci(pool, 30); // warmup
   (void)result;
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -57,12 +60,14 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %zu\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n",
               static_cast<uint64_t>(totalTimeUs.count()));
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
@@ -4,79 +4,64 @@
 #include "citor/hints.h"
 #include "citor/thread_pool.h"
 #include "memusage.hpp"
+#include "utilization.hpp"
 
-#include <atomic>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <thread>
-#include <vector>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 
-static void
-matmul(citor::ThreadPool& pool, int* a, int* b, int* c, int n, int N) {
-  if (n <= 32) {
-    matmul_small(a, b, c, n, N);
+template <typename T>
+static void matmul(citor::ThreadPool& pool, matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
+    matmul_small(t, N);
     return;
   }
-  int k = n / 2;
+  auto s = matmul_split(t, N);
 
   pool.forkJoin<citor::HintsDefaults>(
-    [&] { matmul(pool, a, b, c, k, N); },
-    [&] { matmul(pool, a, b + k, c + k, k, N); },
-    [&] { matmul(pool, a + k * N, b, c + k * N, k, N); },
-    [&] { matmul(pool, a + k * N, b + k, c + k * N + k, k, N); }
+    [&] { matmul(pool, s[0], N); }, [&] { matmul(pool, s[1], N); },
+    [&] { matmul(pool, s[2], N); }, [&] { matmul(pool, s[3], N); }
   );
 
   pool.forkJoin<citor::HintsDefaults>(
-    [&] { matmul(pool, a + k, b + k * N, c, k, N); },
-    [&] { matmul(pool, a + k, b + k * N + k, c + k, k, N); },
-    [&] { matmul(pool, a + k * N + k, b + k * N, c + k * N, k, N); },
-    [&] { matmul(pool, a + k * N + k, b + k * N + k, c + k * N + k, k, N); }
+    [&] { matmul(pool, s[4], N); }, [&] { matmul(pool, s[5], N); },
+    [&] { matmul(pool, s[6], N); }, [&] { matmul(pool, s[7], N); }
   );
 }
 
-static std::vector<int> run_matmul(citor::ThreadPool& pool, int N) {
-  std::vector<int> A(N * N, 1);
-  std::vector<int> B(N * N, 1);
-  std::vector<int> C(N * N, 0);
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+static std::chrono::microseconds run_matmul(
+  citor::ThreadPool& pool, matmul_matrices<T>& M,
+  utilization_result* Cpu = nullptr
+) {
+  M.init();
 
-  int* a = A.data();
-  int* b = B.data();
-  int* c = C.data();
-  matmul(pool, a, b, c, N, N);
-  return C;
-}
-
-static void validate_result(std::vector<int>& C, int N) {
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-  int* c = C.data();
-  for (int i = 0; i < N; ++i) {
-    for (int j = 0; j < N; ++j) {
-      auto res = c[i * N + j];
-      if (res != N) {
-        std::printf(
-          "Wrong result at (%d,%d) : %d. expected %d\n", i, j, res, N
-        );
-        std::fflush(stdout);
-        std::terminate();
-      }
-    }
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  matmul(pool, M.tile(), M.N);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
   }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
 }
 
-static void run_one(citor::ThreadPool& pool, int N) {
-  auto startTime = std::chrono::high_resolution_clock::now();
-  std::vector<int> result = run_matmul(pool, N);
-  auto endTime = std::chrono::high_resolution_clock::now();
-  validate_result(result, N);
-  auto totalTimeUs =
-    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+template <typename T> static void run_one(citor::ThreadPool& pool, int N) {
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(pool, m, &cpu);
+  m.validate();
   std::printf("  - matrix_size: %d\n", N);
   std::printf(
     "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
   );
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -85,10 +70,11 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
   }
   if (argc < 2) {
-    printf("Usage: matmul <matrix size (power of 2)>\n");
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
     exit(0);
   }
-  int n = atoi(argv[1]);
+  // The config selects the base case kernel and the element type.
+  matmul_args args = matmul_parse_args(argc, argv);
   std::printf("threads: %zu\n", thread_count);
   // citor's default PerCpu affinity caps workers at the physical-core
   // count. When the sweep requests every logical CPU, opt into
@@ -99,9 +85,15 @@ int main(int argc, char* argv[]) {
       : citor::Affinity::PerCpu;
   citor::ThreadPool pool(thread_count, affinity);
 
-  run_matmul(pool, n); // warmup
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(pool, warmup);
+    }
+
+    std::printf("runs:\n");
 
-  std::printf("runs:\n");
-  run_one(pool, n);
+    run_one<T>(pool, args.n);
+  });
   return 0;
 }
@@ -1,8 +1,10 @@
 // Port of cpp/libfork/nqueens.cpp using citor::forkJoinAll.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "citor/thread_pool.h"
 #include "citor/hints.h"
+#include "utilization.hpp"
 
 #include <array>
 #include <chrono>
@@ -30,8 +32,8 @@ static void check_answer(int result) {
 
 template <size_t N>
 int nqueens(citor::ThreadPool& pool, int xMax, std::array<char, N> buf) {
-  if (xMax == static_cast<int>(N)) {
-    return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    return nqueens_serial(xMax, buf);
   }
 
   std::array<char, N> ys{};
@@ -88,6 +90,7 @@ int main(int argc, char* argv[]) {
     check_answer(result);
   }
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -98,12 +101,14 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %zu\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n",
               static_cast<uint64_t>(totalTimeUs.count()));
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
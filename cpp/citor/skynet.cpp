@@ -1,8 +1,10 @@
 // Port of cpp/libfork/skynet.cpp using citor::forkJoinAll.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "citor/thread_pool.h"
 #include "citor/hints.h"
+#include "utilization.hpp"
 
 #include <array>
 #include <chrono>
@@ -16,8 +18,8 @@ static const size_t iter_count = 1;
 
 template <size_t DepthMax>
 size_t skynet_one(citor::ThreadPool& pool, size_t BaseNum, size_t Depth) {
-  if (Depth == DepthMax) {
-    return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    return skynet_serial(BaseNum, DepthMax - Depth);
   }
   size_t depthOffset = 1;
   for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
@@ -62,16 +64,19 @@ int main(int argc, char* argv[]) {
   skynet<8>(pool); // warmup
 
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     skynet<8>(pool);
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %zu\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n",
               static_cast<uint64_t>(totalTimeUs.count()));
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
@@ -0,0 +1,160 @@
+// Test performance of a producer-consumer pipeline with multiple CPU-bound
+// stages and a bounded number of items in flight.
+// The workload is defined in 2common/pipeline.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "pipeline.hpp"
+#include <boost/cobalt.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace cobalt = boost::cobalt;
+
+static size_t worker_count = 4;
+static const size_t iter_count = 1;
+
+using channel = cobalt::channel<pipeline_item>;
+
+// cobalt has no pipeline construct, so the stages are connected by channels.
+// The number of items in flight is bounded by a channel of tokens, which the
+// source takes from and the sink returns to. Every stage handles exactly
+// pipeline_item_count items, so the workers of a stage claim an item before
+// reading it, and the channels never need to be closed. cobalt is single
+// threaded, so the claim counters aren't atomic.
+cobalt::promise<void> source(channel& out, cobalt::channel<size_t>& tokens) {
+  for (size_t i = 0; i < pipeline_item_count; ++i) {
+    co_await tokens.read();
+    co_await out.write(pipeline_make_item(i));
+  }
+}
+
+cobalt::promise<void>
+stage_worker(channel& in, channel& out, size_t stage, size_t& claimed) {
+  while (claimed < pipeline_item_count) {
+    ++claimed;
+    pipeline_item item = co_await in.read();
+    item.value = pipeline_stage_work(item.value, stage);
+    co_await out.write(item);
+  }
+}
+
+cobalt::promise<void>
+sink(channel& in, cobalt::channel<size_t>& tokens, pipeline_stats& stats) {
+  for (size_t i = 0; i < pipeline_item_count; ++i) {
+    pipeline_item item = co_await in.read();
+    stats.record(item);
+    co_await tokens.write(i);
+  }
+}
+
+static cobalt::task<void> do_bench(pipeline_stats& stats) {
+  size_t tokenCount = pipeline_token_count(worker_count);
+  cobalt::channel<size_t> tokens(tokenCount);
+  for (size_t i = 0; i < tokenCount; ++i) {
+    co_await tokens.write(i);
+  }
+  std::deque<channel> chans;
+  for (size_t i = 0; i < pipeline_stage_count - 1; ++i) {
+    chans.emplace_back(tokenCount);
+  }
+  std::vector<size_t> claimed(pipeline_stage_count, 0);
+
+  std::vector<cobalt::promise<void>> stages;
+  stages.push_back(source(chans[0], tokens));
+  for (size_t stage = 1; stage < pipeline_stage_count - 1; ++stage) {
+    for (size_t i = 0; i < worker_count; ++i) {
+      stages.push_back(
+        stage_worker(chans[stage - 1], chans[stage], stage, claimed[stage])
+      );
+    }
+  }
+  stages.push_back(sink(chans.back(), tokens, stats));
+  co_await cobalt::join(stages);
+}
+
+cobalt::main co_main(int argc, char* argv[]) {
+  if (argc > 1) {
+    // cobalt doesn't actually support multiple threads but we can still scale
+    // the number of workers per stage and items in flight on a single thread
+    worker_count = static_cast<size_t>(atoi(argv[1]));
+    if (worker_count == 0) {
+      worker_count = 1;
+    }
+  }
+  std::printf("threads: 1\n");
+  std::printf("stages: %zu\n", pipeline_stage_count);
+  std::printf("tokens: %zu\n", pipeline_token_count(worker_count));
+  uint64_t expected = pipeline_expected_checksum();
+
+  {
+    pipeline_stats stats;
+    co_await do_bench(stats); // warmup
+  }
+
+  pipeline_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    co_await do_bench(stats);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  if (stats.count != pipeline_item_count * iter_count ||
+      stats.checksum != expected * iter_count) {
+    std::printf(
+      "FAIL: Expected %zu items with checksum %" PRIu64
+      " but got %zu items with checksum %" PRIu64 "\n",
+      pipeline_item_count * iter_count, expected * iter_count, stats.count,
+      stats.checksum
+    );
+  }
+
+  size_t itemsPerSec = static_cast<size_t>(
+    static_cast<double>(stats.count) * 1000000.0 /
+    static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    items: %zu\n", stats.count);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    items/sec: %zu\n", itemsPerSec);
+  std::printf("    latency_p50: %zu us\n", stats.latency_us(50.0));
+  std::printf("    latency_p99: %zu us\n", stats.latency_us(99.0));
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+  co_return 0;
+}
@@ -19,8 +19,10 @@
 // TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
 // THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "concurrencpp/concurrencpp.h"
+#include "utilization.hpp"
 #include <cinttypes>
 #include <concurrencpp/runtime/runtime.h>
 #include <cstdio>
@@ -33,8 +35,8 @@ static const size_t iter_count = 1;
 result<size_t> fibonacci(
   executor_tag, std::shared_ptr<thread_pool_executor> tpe, const size_t curr
 ) {
-  if (curr < 2) {
-    co_return curr;
+  if (curr < fib_cutoff) {
+    co_return fib_serial(curr);
   }
 
   auto x = fibonacci({}, tpe, curr - 1);
@@ -61,6 +63,7 @@ int main(int argc, char* argv[]) {
   auto result =
     fibonacci({}, runtime.thread_pool_executor(), 30).get(); // warmup
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -69,11 +72,13 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
\ No newline at end of file
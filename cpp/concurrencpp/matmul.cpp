@@ -10,6 +10,7 @@
 #include "memusage.hpp"
 #include "matmul.hpp"
 #include "concurrencpp/concurrencpp.h"
+#include "utilization.hpp"
 #include <concurrencpp/results/constants.h>
 #include <concurrencpp/runtime/runtime.h>
 
@@ -17,83 +18,70 @@
 #include <concurrencpp/task.h>
 #include <cstdio>
 #include <cstdlib>
-#include <exception>
 #include <thread>
-#include <vector>
 
 using namespace concurrencpp;
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 
+template <typename T>
 result<void> matmul(
-  executor_tag, std::shared_ptr<thread_pool_executor> executor, int* a, int* b,
-  int* c, int n, int N
+  executor_tag, std::shared_ptr<thread_pool_executor> executor,
+  matmul_tile<T> t, int N
 ) {
-  if (n <= 32) {
+  if (matmul_is_leaf(t)) {
     // Base case: Use simple triple-loop multiplication for small matrices
-    matmul_small(a, b, c, n, N);
+    matmul_small(t, N);
   } else {
     // Recursive case: Divide the matrices into 4 submatrices and multiply them
-    int k = n / 2;
+    auto s = matmul_split(t, N);
 
     // Split the execution into 2 sections to ensure output locations are not
     // written in parallel
     std::array<result<void>, 4> children;
-    children[0] = matmul({}, executor, a, b, c, k, N);
-    children[1] = matmul({}, executor, a, b + k, c + k, k, N);
-    children[2] = matmul({}, executor, a + k * N, b, c + k * N, k, N);
-    children[3] = matmul({}, executor, a + k * N, b + k, c + k * N + k, k, N);
+    for (size_t i = 0; i < 4; ++i) {
+      children[i] = matmul<T>({}, executor, s[i], N);
+    }
     co_await when_all(executor, children.begin(), children.end());
 
-    children[0] = matmul({}, executor, a + k, b + k * N, c, k, N);
-    children[1] = matmul({}, executor, a + k, b + k * N + k, c + k, k, N);
-    children[2] =
-      matmul({}, executor, a + k * N + k, b + k * N, c + k * N, k, N);
-    children[3] =
-      matmul({}, executor, a + k * N + k, b + k * N + k, c + k * N + k, k, N);
+    for (size_t i = 0; i < 4; ++i) {
+      children[i] = matmul<T>({}, executor, s[4 + i], N);
+    }
     co_await when_all(executor, children.begin(), children.end());
   }
 }
 
-std::vector<int>
-run_matmul(std::shared_ptr<thread_pool_executor> executor, int N) {
-  std::vector<int> A(N * N, 1);
-  std::vector<int> B(N * N, 1);
-  std::vector<int> C(N * N, 0);
-
-  int* a = A.data();
-  int* b = B.data();
-  int* c = C.data();
-  matmul({}, executor, a, b, c, N, N).wait();
-  return C;
-}
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  std::shared_ptr<thread_pool_executor> executor, matmul_matrices<T>& M,
+  utilization_result* Cpu = nullptr
+) {
+  M.init();
 
-void validate_result(std::vector<int>& C, int N) {
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-  int* c = C.data();
-  for (int i = 0; i < N; i++) {
-    for (int j = 0; j < N; j++) {
-      auto res = c[i * N + j];
-      if (res != N) {
-        std::printf(
-          "Wrong result at (%d,%d) : %d. expected %d\n", i, j, res, N
-        );
-        std::fflush(stdout);
-        std::terminate();
-      }
-    }
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  matmul<T>({}, executor, M.tile(), M.N).wait();
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
   }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
 }
 
+template <typename T>
 void run_one(std::shared_ptr<thread_pool_executor> executor, int N) {
-  auto startTime = std::chrono::high_resolution_clock::now();
-  std::vector<int> result = run_matmul(executor, N);
-  auto endTime = std::chrono::high_resolution_clock::now();
-  validate_result(result, N);
-  auto totalTimeUs =
-    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(executor, m, &cpu);
+  m.validate();
   std::printf("  - matrix_size: %d\n", N);
-  std::printf("    duration: %zu us\n", totalTimeUs.count());
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -102,18 +90,24 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
   }
   if (argc < 2) {
-    printf("Usage: matmul <matrix size (power of 2)>\n");
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
     exit(0);
   }
-  int n = atoi(argv[1]);
+  // The config selects the base case kernel and the element type.
+  matmul_args args = matmul_parse_args(argc, argv);
   std::printf("threads: %zu\n", thread_count);
   concurrencpp::runtime_options opt;
   opt.max_cpu_threads = thread_count;
   concurrencpp::runtime runtime(opt);
 
-  run_matmul(runtime.thread_pool_executor(), n); // warmup
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(runtime.thread_pool_executor(), warmup);
+    }
 
-  std::printf("runs:\n");
+    std::printf("runs:\n");
 
-  run_one(runtime.thread_pool_executor(), n);
+    run_one<T>(runtime.thread_pool_executor(), args.n);
+  });
 }
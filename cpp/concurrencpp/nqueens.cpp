@@ -10,8 +10,10 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "concurrencpp/concurrencpp.h"
+#include "utilization.hpp"
 #include <concurrencpp/runtime/runtime.h>
 
 #include <array>
@@ -55,8 +57,8 @@ result<int> nqueens(
   executor_tag, std::shared_ptr<thread_pool_executor> executor, int xMax,
   std::array<char, N> buf
 ) {
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   auto tasks = std::ranges::views::iota(0UL, N) |
@@ -104,6 +106,7 @@ int main(int argc, char* argv[]) {
     check_answer(result);
   }
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -114,11 +117,13 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
@@ -28,8 +28,10 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "concurrencpp/concurrencpp.h"
+#include "utilization.hpp"
 #include <concurrencpp/runtime/runtime.h>
 
 #include <chrono>
@@ -46,8 +48,8 @@ result<size_t> skynet_one(
   executor_tag, std::shared_ptr<thread_pool_executor> executor, size_t BaseNum,
   size_t Depth
 ) {
-  if (Depth == DepthMax) {
-    co_return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    co_return skynet_serial(BaseNum, DepthMax - Depth);
   }
   size_t depthOffset = 1;
   for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
@@ -82,15 +84,18 @@ template <size_t Depth = 6>
 result<void>
 loop_skynet(executor_tag, std::shared_ptr<thread_pool_executor> executor) {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     co_await skynet<Depth>({}, executor);
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
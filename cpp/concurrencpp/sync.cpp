@@ -0,0 +1,144 @@
+// Test performance of the async synchronization primitives under contention.
+// A configurable number of tasks hammer a single primitive; the task count is
+// the contention level. Supported primitives: mutex
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "concurrencpp/concurrencpp.h"
+#include <concurrencpp/runtime/runtime.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace concurrencpp;
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 16;
+static std::string primitive = "mutex";
+static const size_t iter_count = 1;
+
+static constexpr size_t op_count = 10000000;
+
+// Only accessed while holding the lock.
+static size_t mutex_counter;
+
+result<void> mutex_worker(
+  executor_tag, std::shared_ptr<thread_pool_executor> executor,
+  async_lock& lock, size_t count
+) {
+  for (size_t i = 0; i < count; ++i) {
+    auto guard = co_await lock.lock(executor);
+    ++mutex_counter;
+  }
+}
+
+// Returns the number of operations performed.
+result<size_t>
+do_bench(executor_tag, std::shared_ptr<thread_pool_executor> executor) {
+  mutex_counter = 0;
+
+  size_t per_task = op_count / task_count;
+  size_t rem = op_count % task_count;
+
+  async_lock lock;
+  std::vector<result<void>> tasks;
+  tasks.reserve(task_count);
+  for (size_t i = 0; i < task_count; ++i) {
+    tasks.push_back(
+      mutex_worker({}, executor, lock, i < rem ? per_task + 1 : per_task)
+    );
+  }
+  auto done = co_await when_all(executor, tasks.begin(), tasks.end());
+  for (auto& res : done) {
+    co_await res;
+  }
+  if (mutex_counter != op_count) {
+    std::printf(
+      "FAIL: Expected %zu increments but got %zu\n", op_count, mutex_counter
+    );
+  }
+  co_return mutex_counter;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+    if (task_count == 0) {
+      task_count = 1;
+    }
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc > 3) {
+    primitive = argv[3];
+  }
+  if (primitive != "mutex") {
+    std::printf("Unknown primitive: %s\n", primitive.c_str());
+    std::printf("Usage: sync <task count> [thread count] [mutex]\n");
+    exit(1);
+  }
+
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+  std::printf("primitive: %s\n", primitive.c_str());
+  concurrencpp::runtime_options opt;
+  opt.max_cpu_threads = thread_count;
+  concurrencpp::runtime runtime(opt);
+
+  {
+    auto result = do_bench({}, runtime.thread_pool_executor()).get(); // warmup
+    std::printf("output: %zu\n", result);
+  }
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  size_t ops = 0;
+  for (size_t i = 0; i < iter_count; ++i) {
+    ops += do_bench({}, runtime.thread_pool_executor()).get();
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  size_t opsPerSec = static_cast<size_t>(
+    static_cast<double>(ops) * 1000000.0 / static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    operations: %zu\n", ops);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    operations/sec: %zu\n", opsPerSec);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+  return 0;
+}
@@ -26,10 +26,12 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "start_tasks.h"
 #include "thread_pool.h"
 #include "wait_tasks.h"
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cinttypes>
@@ -40,8 +42,8 @@ static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 
 static coros::Task<size_t> fib(size_t n) {
-  if (n < 2)
-    co_return n;
+  if (n < fib_cutoff)
+    co_return fib_serial(n);
 
   coros::Task<size_t> x = fib(n - 1);
   coros::Task<size_t> y = fib(n - 2);
@@ -66,6 +68,7 @@ int main(int argc, char* argv[]) {
 
   coros::start_sync(tp, fib(30));
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -76,10 +79,12 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
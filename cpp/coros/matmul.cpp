@@ -12,79 +12,65 @@
 #include "start_tasks.h"
 #include "thread_pool.h"
 #include "wait_tasks.h"
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
-#include <exception>
-#include <vector>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 
-coros::Task<void> matmul(int* a, int* b, int* c, int n, int N) {
-  if (n <= 32) {
+template <typename T> coros::Task<void> matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
     // Base case: Use simple triple-loop multiplication for small matrices
-    matmul_small(a, b, c, n, N);
+    matmul_small(t, N);
   } else {
     // Recursive case: Divide the matrices into 4 submatrices and multiply them
-    int k = n / 2;
+    auto s = matmul_split(t, N);
 
     // Split the execution into 2 sections to ensure output locations are not
     // written in parallel
     co_await coros::wait_tasks(
-      matmul(a, b, c, k, N), matmul(a, b + k, c + k, k, N),
-      matmul(a + k * N, b, c + k * N, k, N),
-      matmul(a + k * N, b + k, c + k * N + k, k, N)
+      matmul(s[0], N), matmul(s[1], N), matmul(s[2], N), matmul(s[3], N)
     );
 
     co_await coros::wait_tasks(
-      matmul(a + k, b + k * N, c, k, N),
-      matmul(a + k, b + k * N + k, c + k, k, N),
-      matmul(a + k * N + k, b + k * N, c + k * N, k, N),
-      matmul(a + k * N + k, b + k * N + k, c + k * N + k, k, N)
+      matmul(s[4], N), matmul(s[5], N), matmul(s[6], N), matmul(s[7], N)
     );
   }
 }
 
-std::vector<int> run_matmul(coros::ThreadPool& executor, int N) {
-  std::vector<int> A(N * N, 1);
-  std::vector<int> B(N * N, 1);
-  std::vector<int> C(N * N, 0);
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  coros::ThreadPool& executor, matmul_matrices<T>& M,
+  utilization_result* Cpu = nullptr
+) {
+  M.init();
 
-  int* a = A.data();
-  int* b = B.data();
-  int* c = C.data();
-  coros::Task<void> t = matmul(a, b, c, N, N);
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  coros::Task<void> t = matmul(M.tile(), M.N);
   coros::start_sync(executor, t);
-  return C;
-}
-
-void validate_result(std::vector<int>& C, int N) {
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-  int* c = C.data();
-  for (int i = 0; i < N; i++) {
-    for (int j = 0; j < N; j++) {
-      auto res = c[i * N + j];
-      if (res != N) {
-        std::printf(
-          "Wrong result at (%d,%d) : %d. expected %d\n", i, j, res, N
-        );
-        std::fflush(stdout);
-        std::terminate();
-      }
-    }
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
   }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
 }
 
-void run_one(coros::ThreadPool& executor, int N) {
-  auto startTime = std::chrono::high_resolution_clock::now();
-  std::vector<int> result = run_matmul(executor, N);
-  auto endTime = std::chrono::high_resolution_clock::now();
-  validate_result(result, N);
-  auto totalTimeUs =
-    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+template <typename T> void run_one(coros::ThreadPool& executor, int N) {
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(executor, m, &cpu);
+  m.validate();
   std::printf("  - matrix_size: %d\n", N);
-  std::printf("    duration: %zu us\n", totalTimeUs.count());
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -93,16 +79,22 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
   }
   if (argc < 2) {
-    printf("Usage: matmul <matrix size (power of 2)>\n");
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
     exit(0);
   }
-  int n = atoi(argv[1]);
+  // The config selects the base case kernel and the element type.
+  matmul_args args = matmul_parse_args(argc, argv);
   std::printf("threads: %zu\n", thread_count);
   coros::ThreadPool executor(thread_count);
 
-  run_matmul(executor, n); // warmup
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(executor, warmup);
+    }
 
-  std::printf("runs:\n");
+    std::printf("runs:\n");
 
-  run_one(executor, n);
+    run_one<T>(executor, args.n);
+  });
 }
@@ -10,10 +10,12 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "start_tasks.h"
 #include "thread_pool.h"
 #include "wait_tasks.h"
+#include "utilization.hpp"
 #include <array>
 #include <cinttypes>
 #include <cstdio>
@@ -39,8 +41,8 @@ void check_answer(int result) {
 
 template <size_t N>
 coros::Task<int> nqueens(int xMax, std::array<char, N> buf) {
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   auto tasks = std::ranges::views::iota(0UL, N) |
@@ -86,6 +88,7 @@ int main(int argc, char* argv[]) {
     check_answer(result);
   }
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -98,10 +101,12 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
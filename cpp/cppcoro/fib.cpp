@@ -26,7 +26,9 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 #include <cppcoro/schedule_on.hpp>
 #include <cppcoro/shared_task.hpp>
 #include <cppcoro/static_thread_pool.hpp>
@@ -43,8 +45,8 @@ static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 
 static cppcoro::task<size_t> fib(cppcoro::static_thread_pool& tp, size_t n) {
-  if (n < 2)
-    co_return n;
+  if (n < fib_cutoff)
+    co_return fib_serial(n);
 
   // Fork the tasks in parallel and retrieve the results in a tuple.
   // Use schedule_on to ensure that the first task is forked and the 2nd task is
@@ -80,6 +82,7 @@ int main(int argc, char* argv[]) {
       co_await tp.schedule();
       auto result = co_await fib(tp, 30); // warmup
 
+      auto startCpu = utilization_now();
       auto startTime = std::chrono::high_resolution_clock::now();
 
       for (size_t i = 0; i < iter_count; ++i) {
@@ -88,12 +91,14 @@ int main(int argc, char* argv[]) {
       }
 
       auto endTime = std::chrono::high_resolution_clock::now();
+      auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
       auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
         endTime - startTime
       );
       std::printf("runs:\n");
       std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
       std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+      cpu.print_yaml();
       std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
       co_return 0;
     }(tp, n)
@@ -10,7 +10,9 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 #include <cppcoro/schedule_on.hpp>
 #include <cppcoro/shared_task.hpp>
 #include <cppcoro/static_thread_pool.hpp>
@@ -46,8 +48,8 @@ template <size_t N>
 cppcoro::task<int>
 nqueens(cppcoro::static_thread_pool& tp, int xMax, std::array<char, N> buf) {
   // Only reschedule onto the pool for internal nodes that actually fan out.
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   co_await tp.schedule();
@@ -99,6 +101,7 @@ int main(int argc, char* argv[]) {
         check_answer(result);
       }
 
+      auto startCpu = utilization_now();
       auto startTime = std::chrono::high_resolution_clock::now();
 
       for (size_t i = 0; i < iter_count; ++i) {
@@ -109,12 +112,14 @@ int main(int argc, char* argv[]) {
       }
 
       auto endTime = std::chrono::high_resolution_clock::now();
+      auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
       auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
         endTime - startTime
       );
       std::printf("runs:\n");
       std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
       std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+      cpu.print_yaml();
       std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
       co_return 0;
     }(tp)
@@ -28,7 +28,9 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 #include <cppcoro/schedule_on.hpp>
 #include <cppcoro/shared_task.hpp>
 #include <cppcoro/static_thread_pool.hpp>
@@ -51,8 +53,8 @@ cppcoro::task<size_t>
 skynet_one(cppcoro::static_thread_pool& tp, size_t BaseNum, size_t Depth) {
   co_await tp.schedule();
 
-  if (Depth == DepthMax) {
-    co_return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    co_return skynet_serial(BaseNum, DepthMax - Depth);
   }
 
   size_t depthOffset = 1;
@@ -89,15 +91,18 @@ cppcoro::task<void> skynet(cppcoro::static_thread_pool& tp) {
 template <size_t Depth = 6>
 cppcoro::task<void> loop_skynet(cppcoro::static_thread_pool& tp) {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     co_await skynet<Depth>(tp);
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -0,0 +1,225 @@
+// Test performance of the async synchronization primitives under contention.
+// A configurable number of tasks hammer a single primitive; the task count is
+// the contention level. Supported primitives: mutex, latch, event. cppcoro
+// has no semaphore or barrier, so those aren't measured here.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include <cppcoro/async_latch.hpp>
+#include <cppcoro/async_manual_reset_event.hpp>
+#include <cppcoro/async_mutex.hpp>
+#include <cppcoro/static_thread_pool.hpp>
+#include <cppcoro/sync_wait.hpp>
+#include <cppcoro/task.hpp>
+#include <cppcoro/when_all.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 16;
+static std::string primitive = "mutex";
+static const size_t iter_count = 1;
+
+static constexpr size_t op_count = 10000000;
+
+// A latch can't be reused, so each round gets its own. The rounds are capped
+// to bound the memory used by the latches.
+static constexpr size_t latch_max_rounds = 100000;
+
+// Only accessed while holding the mutex.
+static size_t mutex_counter;
+
+static std::atomic<size_t> ops_done;
+static std::atomic<size_t> arrived;
+
+static cppcoro::task<void> mutex_worker(
+  cppcoro::static_thread_pool& tp, cppcoro::async_mutex& mtx, size_t count
+) {
+  co_await tp.schedule();
+  for (size_t i = 0; i < count; ++i) {
+    co_await mtx.lock_async();
+    ++mutex_counter;
+    mtx.unlock();
+  }
+}
+
+static cppcoro::task<void>
+latch_worker(cppcoro::static_thread_pool& tp, std::deque<cppcoro::async_latch>& latches) {
+  co_await tp.schedule();
+  for (auto& l : latches) {
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    l.count_down();
+    co_await l;
+  }
+}
+
+// The manual-reset events alternate between rounds. The last task to arrive
+// at a round resets the other event and then sets this round's event. No task
+// is still waiting on the event being reset, since every task has already
+// arrived at this round.
+static cppcoro::task<void> event_worker(
+  cppcoro::static_thread_pool& tp, cppcoro::async_manual_reset_event (&events)[2], size_t rounds
+) {
+  co_await tp.schedule();
+  for (size_t i = 0; i < rounds; ++i) {
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == task_count) {
+      arrived.store(0, std::memory_order_relaxed);
+      events[(i + 1) % 2].reset();
+      events[i % 2].set();
+    }
+    co_await events[i % 2];
+  }
+}
+
+// Returns the number of operations performed.
+static cppcoro::task<size_t> do_bench(cppcoro::static_thread_pool& tp) {
+  mutex_counter = 0;
+  ops_done = 0;
+  arrived = 0;
+
+  size_t per_task = op_count / task_count;
+  size_t rem = op_count % task_count;
+
+  std::vector<cppcoro::task<void>> tasks;
+  tasks.reserve(task_count);
+  if (primitive == "mutex") {
+    cppcoro::async_mutex mtx;
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks.push_back(
+        mutex_worker(tp, mtx, i < rem ? per_task + 1 : per_task)
+      );
+    }
+    co_await cppcoro::when_all(std::move(tasks));
+    if (mutex_counter != op_count) {
+      std::printf(
+        "FAIL: Expected %zu increments but got %zu\n", op_count, mutex_counter
+      );
+    }
+    co_return mutex_counter;
+  } else if (primitive == "latch") {
+    std::deque<cppcoro::async_latch> latches;
+    size_t rounds = per_task < latch_max_rounds ? per_task : latch_max_rounds;
+    for (size_t i = 0; i < rounds; ++i) {
+      latches.emplace_back(static_cast<std::ptrdiff_t>(task_count));
+    }
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks.push_back(latch_worker(tp, latches));
+    }
+    co_await cppcoro::when_all(std::move(tasks));
+    if (ops_done != rounds * task_count) {
+      std::printf(
+        "FAIL: Expected %zu arrivals but got %zu\n", rounds * task_count,
+        ops_done.load()
+      );
+    }
+  } else {
+    // Every task must arrive at each round, so all tasks run the same number
+    // of rounds and the remainder is dropped.
+    cppcoro::async_manual_reset_event events[2];
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks.push_back(event_worker(tp, events, per_task));
+    }
+    co_await cppcoro::when_all(std::move(tasks));
+    if (ops_done != per_task * task_count) {
+      std::printf(
+        "FAIL: Expected %zu arrivals but got %zu\n", per_task * task_count,
+        ops_done.load()
+      );
+    }
+  }
+  co_return ops_done.load();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+    if (task_count == 0) {
+      task_count = 1;
+    }
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc > 3) {
+    primitive = argv[3];
+  }
+  if (primitive != "mutex" && primitive != "latch" && primitive != "event") {
+    std::printf("Unknown primitive: %s\n", primitive.c_str());
+    std::printf("Usage: sync <task count> [thread count] "
+                "[mutex|latch|event]\n");
+    exit(1);
+  }
+
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+  std::printf("primitive: %s\n", primitive.c_str());
+
+  cppcoro::static_thread_pool tp(thread_count);
+
+  return cppcoro::sync_wait(
+    [](cppcoro::static_thread_pool& tp) -> cppcoro::task<int> {
+      co_await tp.schedule();
+      {
+        auto result = co_await do_bench(tp); // warmup
+        std::printf("output: %zu\n", result);
+      }
+
+      auto startTime = std::chrono::high_resolution_clock::now();
+
+      size_t ops = 0;
+      for (size_t i = 0; i < iter_count; ++i) {
+        ops += co_await do_bench(tp);
+      }
+
+      auto endTime = std::chrono::high_resolution_clock::now();
+      auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                           endTime - startTime
+      )
+                           .count();
+
+      size_t opsPerSec = static_cast<size_t>(
+        static_cast<double>(ops) * 1000000.0 / static_cast<double>(totalTimeUs)
+      );
+      std::printf("runs:\n");
+      std::printf("  - iteration_count: %zu\n", iter_count);
+      std::printf("    operations: %zu\n", ops);
+      std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+      std::printf("    operations/sec: %zu\n", opsPerSec);
+      std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+      co_return 0;
+    }(tp)
+  );
+}
@@ -0,0 +1,133 @@
+// Test the impact of blocking calls made from tasks.
+// A fraction of otherwise CPU-bound tasks make a blocking call. The call is
+// either made in place on the worker thread, or offloaded using the library's
+// mechanism for blocking work. Reports the task throughput.
+// The workload is defined in 2common/blocking.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "blocking.hpp"
+#include "memusage.hpp"
+
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
+#include <folly/coro/Task.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t pct = 1;
+
+static folly::coro::Task<void> blocking_call_task() {
+  blocking_call();
+  co_return;
+}
+
+// When BlockingEx is set, the blocking call runs there and this task resumes
+// on the CPU executor afterward. This frees the worker thread to run other
+// tasks in the meantime.
+static folly::coro::Task<void> run_task(
+  size_t Index, folly::Executor* BlockingEx, std::vector<uint64_t>& Results
+) {
+  if (blocking_is_blocking(Index, pct)) {
+    if (BlockingEx != nullptr) {
+      co_await co_withExecutor(BlockingEx, blocking_call_task());
+    } else {
+      blocking_call();
+    }
+  }
+  Results[Index] = blocking_cpu_work(Index);
+}
+
+static folly::coro::Task<void>
+run_all(folly::Executor* BlockingEx, std::vector<uint64_t>& Results) {
+  std::vector<folly::coro::Task<void>> tasks;
+  tasks.reserve(blocking_task_count);
+  for (size_t i = 0; i < blocking_task_count; ++i) {
+    tasks.push_back(run_task(i, BlockingEx, Results));
+  }
+  co_await folly::coro::collectAllRange(std::move(tasks));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    pct = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  bool offload = argc > 3 && strcmp(argv[3], "offload") == 0;
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("blocking_pct: %zu\n", pct);
+  folly::CPUThreadPoolExecutor executor(thread_count);
+  folly::IOThreadPoolExecutor blockingExecutor(
+    offload ? blocking_offload_threads : 1
+  );
+  uint64_t expected = blocking_expected_checksum();
+
+  std::vector<uint64_t> results(blocking_task_count);
+  folly::coro::blockingWait(co_withExecutor(
+    &executor, run_all(offload ? &blockingExecutor : nullptr, results)
+  )); // warmup
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  folly::coro::blockingWait(co_withExecutor(
+    &executor, run_all(offload ? &blockingExecutor : nullptr, results)
+  ));
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  uint64_t sum = 0;
+  for (uint64_t r : results) {
+    sum += r;
+  }
+  if (sum != expected) {
+    std::printf(
+      "FAIL: expected checksum %" PRIu64 " but got %" PRIu64 "\n", expected, sum
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    tasks: %zu\n", blocking_task_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    tasks/sec: %zu\n",
+    static_cast<size_t>(blocking_task_count * 1000000 / totalTimeUs)
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
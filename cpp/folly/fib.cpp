@@ -26,7 +26,9 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 
 #include <folly/coro/BlockingWait.h>
 #include <folly/coro/Collect.h>
@@ -45,8 +47,8 @@ static const size_t iter_count = 1;
 // folly::coro::collectAll starts the child tasks concurrently on the
 // current executor; this is folly's idiomatic fork-join construct.
 static folly::coro::Task<size_t> fib(size_t n) {
-  if (n < 2) {
-    co_return n;
+  if (n < fib_cutoff) {
+    co_return fib_serial(n);
   }
 
   auto [x, y] = co_await folly::coro::collectAll(fib(n - 1), fib(n - 2));
@@ -69,6 +71,7 @@ int main(int argc, char* argv[]) {
   auto result =
     folly::coro::blockingWait(co_withExecutor(&executor, fib(30))); // warmup
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -77,11 +80,13 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
@@ -0,0 +1,102 @@
+// Test performance of flat (non-recursive) task submission.
+// A single external thread submits many tiny independent tasks to the
+// executor, which measures the injection path rather than the local deque
+// fast path that the recursive benchmarks hit. Reports both the rate at which
+// the external thread can submit, and the time until every task has run.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <latch>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+static constexpr size_t task_count = 10000000;
+
+struct result {
+  size_t submit_us;
+  size_t total_us;
+};
+
+static result do_bench(folly::CPUThreadPoolExecutor& executor) {
+  std::latch done(task_count);
+  auto startTime = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < task_count; ++i) {
+    executor.add([&done]() { done.count_down(); });
+  }
+  auto submitTime = std::chrono::high_resolution_clock::now();
+  done.wait();
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto submitUs = std::chrono::duration_cast<std::chrono::microseconds>(
+    submitTime - startTime
+  );
+  auto totalUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  return result{
+    static_cast<size_t>(submitUs.count()), static_cast<size_t>(totalUs.count())
+  };
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+
+  std::printf("threads: %zu\n", thread_count);
+  folly::CPUThreadPoolExecutor executor(thread_count);
+
+  do_bench(executor); // warmup
+
+  size_t submitUs = 0;
+  size_t totalUs = 0;
+  for (size_t i = 0; i < iter_count; ++i) {
+    auto r = do_bench(executor);
+    submitUs += r.submit_us;
+    totalUs += r.total_us;
+  }
+
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    tasks: %zu\n", task_count);
+  std::printf("    duration: %zu us\n", totalUs);
+  std::printf(
+    "    tasks/sec: %zu\n", task_count * iter_count * 1000000 / totalUs
+  );
+  std::printf("    submit_duration: %zu us\n", submitUs);
+  std::printf(
+    "    submits/sec: %zu\n", task_count * iter_count * 1000000 / submitUs
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -0,0 +1,138 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Find-first variant: stops all outstanding work once the single matching
+// solution defined in 2common/nqueens_first.hpp is found.
+
+#include "memusage.hpp"
+#include "nqueens_first.hpp"
+
+#include <folly/CancellationToken.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
+#include <folly/coro/Task.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+// The root task is started with the token of Source, and collectAllRange
+// passes it on to every child. Once the answer is found, the remaining tasks
+// see the cancellation request and return immediately.
+template <size_t N>
+folly::coro::Task<void> nqueens_first(
+  int xMax, std::array<char, N> buf, nqueens_first_state& State,
+  folly::CancellationSource& Source
+) {
+  const auto& token = co_await folly::coro::co_current_cancellation_token;
+  if (token.isCancellationRequested()) {
+    co_return;
+  }
+  if (N == xMax) {
+    uint64_t hash = nqueens_first_hash(buf);
+    if (nqueens_first_match(hash) && State.publish(hash)) {
+      Source.requestCancellation();
+    }
+    co_return;
+  }
+
+  std::vector<folly::coro::Task<void>> tasks;
+  tasks.reserve(N);
+  for (int y = 0; y < static_cast<int>(N); ++y) {
+    char q = static_cast<char>(y);
+    bool valid = true;
+    for (int x = 0; x < xMax; x++) {
+      char p = buf[x];
+      if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+        valid = false;
+        break;
+      }
+    }
+    if (valid) {
+      buf[xMax] = q;
+      tasks.push_back(nqueens_first(xMax + 1, buf, State, Source));
+    }
+  }
+
+  co_await folly::coro::collectAllRange(std::move(tasks));
+}
+
+static void run_one(folly::Executor* Ex, nqueens_first_state& State) {
+  folly::CancellationSource source;
+  std::array<char, nqueens_first_work> buf{};
+  folly::coro::blockingWait(co_withExecutor(
+    Ex, folly::coro::co_withCancellation(
+          source.getToken(), nqueens_first(0, buf, State, source)
+        )
+  ));
+}
+
+static void check_answer(const nqueens_first_state& State) {
+  if (!State.found() || State.answer != nqueens_first_answer) {
+    std::printf(
+      "FAIL: expected %" PRIu64 ", got %" PRIu64 "\n", nqueens_first_answer,
+      State.answer
+    );
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  folly::CPUThreadPoolExecutor executor(thread_count);
+
+  {
+    nqueens_first_state state;
+    run_one(&executor, state); // warmup
+    check_answer(state);
+  }
+
+  size_t answerUs = 0;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    nqueens_first_state state;
+    auto iterStart = std::chrono::steady_clock::now();
+    run_one(&executor, state);
+    check_answer(state);
+    answerUs += static_cast<size_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        state.found_at - iterStart
+      )
+        .count()
+    );
+    std::printf("output: %" PRIu64 "\n", state.answer);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf("    time_to_answer: %zu us\n", answerUs);
+  std::printf("    drain: %zu us\n", totalTimeUs - answerUs);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+  return 0;
+}
@@ -0,0 +1,167 @@
+// Test performance of a producer-consumer pipeline with multiple CPU-bound
+// stages and a bounded number of items in flight.
+// The workload is defined in 2common/pipeline.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "pipeline.hpp"
+
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
+#include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/Task.h>
+#include <folly/coro/UnboundedQueue.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+using channel = folly::coro::UnboundedQueue<pipeline_item>;
+
+// folly has no pipeline construct, so the stages are connected by queues.
+// The number of items in flight is bounded by a queue of tokens, which the
+// source takes from and the sink returns to. UnboundedQueue has no close
+// operation, but every stage handles exactly pipeline_item_count items, so
+// the workers of a stage claim an item before dequeueing it.
+static folly::coro::Task<void>
+source(channel& out, folly::coro::UnboundedQueue<size_t>& tokens) {
+  // collectAllRange starts each task inline; reschedule so that the stages
+  // actually run on the workers.
+  co_await folly::coro::co_reschedule_on_current_executor;
+  for (size_t i = 0; i < pipeline_item_count; ++i) {
+    co_await tokens.dequeue();
+    out.enqueue(pipeline_make_item(i));
+  }
+}
+
+static folly::coro::Task<void> stage_worker(
+  channel& in, channel& out, size_t stage, std::atomic<size_t>& claimed
+) {
+  co_await folly::coro::co_reschedule_on_current_executor;
+  while (claimed.fetch_add(1, std::memory_order_relaxed) <
+         pipeline_item_count) {
+    pipeline_item item = co_await in.dequeue();
+    item.value = pipeline_stage_work(item.value, stage);
+    out.enqueue(item);
+  }
+}
+
+static folly::coro::Task<void> sink(
+  channel& in, folly::coro::UnboundedQueue<size_t>& tokens,
+  pipeline_stats& stats
+) {
+  co_await folly::coro::co_reschedule_on_current_executor;
+  for (size_t i = 0; i < pipeline_item_count; ++i) {
+    pipeline_item item = co_await in.dequeue();
+    stats.record(item);
+    tokens.enqueue(i);
+  }
+}
+
+static folly::coro::Task<void> do_bench(pipeline_stats& stats) {
+  folly::coro::UnboundedQueue<size_t> tokens;
+  for (size_t i = 0; i < pipeline_token_count(thread_count); ++i) {
+    tokens.enqueue(i);
+  }
+  std::deque<channel> chans(pipeline_stage_count - 1);
+  std::deque<std::atomic<size_t>> claimed(pipeline_stage_count);
+
+  std::vector<folly::coro::Task<void>> tasks;
+  tasks.push_back(source(chans[0], tokens));
+  for (size_t stage = 1; stage < pipeline_stage_count - 1; ++stage) {
+    for (size_t i = 0; i < thread_count; ++i) {
+      tasks.push_back(
+        stage_worker(chans[stage - 1], chans[stage], stage, claimed[stage])
+      );
+    }
+  }
+  tasks.push_back(sink(chans.back(), tokens, stats));
+  co_await folly::coro::collectAllRange(std::move(tasks));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("stages: %zu\n", pipeline_stage_count);
+  std::printf("tokens: %zu\n", pipeline_token_count(thread_count));
+  uint64_t expected = pipeline_expected_checksum();
+  folly::CPUThreadPoolExecutor executor(thread_count);
+
+  {
+    pipeline_stats stats;
+    folly::coro::blockingWait(
+      co_withExecutor(&executor, do_bench(stats))
+    ); // warmup
+  }
+
+  pipeline_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    folly::coro::blockingWait(co_withExecutor(&executor, do_bench(stats)));
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  if (stats.count != pipeline_item_count * iter_count ||
+      stats.checksum != expected * iter_count) {
+    std::printf(
+      "FAIL: Expected %zu items with checksum %" PRIu64
+      " but got %zu items with checksum %" PRIu64 "\n",
+      pipeline_item_count * iter_count, expected * iter_count, stats.count,
+      stats.checksum
+    );
+  }
+
+  size_t itemsPerSec = static_cast<size_t>(
+    static_cast<double>(stats.count) * 1000000.0 /
+    static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    items: %zu\n", stats.count);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    items/sec: %zu\n", itemsPerSec);
+  std::printf("    latency_p50: %zu us\n", stats.latency_us(50.0));
+  std::printf("    latency_p99: %zu us\n", stats.latency_us(99.0));
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -0,0 +1,184 @@
+// Test performance of the async synchronization primitives under contention.
+// A configurable number of tasks hammer a single primitive; the task count is
+// the contention level. Supported primitives: mutex
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+
+#include <folly/coro/Baton.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
+#include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/Mutex.h>
+#include <folly/coro/Task.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 16;
+static std::string primitive = "mutex";
+static const size_t iter_count = 1;
+
+static constexpr size_t op_count = 10000000;
+
+// Only accessed while holding the mutex.
+static size_t mutex_counter;
+
+static std::atomic<size_t> ops_done;
+static std::atomic<size_t> arrived;
+
+static folly::coro::Task<void>
+mutex_worker(folly::coro::Mutex& mtx, size_t count) {
+  // collectAllRange starts each task inline; reschedule so that the workers
+  // actually contend from different threads.
+  co_await folly::coro::co_reschedule_on_current_executor;
+  for (size_t i = 0; i < count; ++i) {
+    co_await mtx.co_lock();
+    ++mutex_counter;
+    mtx.unlock();
+  }
+}
+
+// folly::coro::Baton is a manual-reset event. The batons alternate between
+// rounds. The last task to arrive at a round resets the other baton and then
+// posts this round's baton. No task is still waiting on the baton being
+// reset, since every task has already arrived at this round.
+static folly::coro::Task<void>
+event_worker(folly::coro::Baton (&batons)[2], size_t rounds) {
+  co_await folly::coro::co_reschedule_on_current_executor;
+  for (size_t i = 0; i < rounds; ++i) {
+    ops_done.fetch_add(1, std::memory_order_relaxed);
+    if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == task_count) {
+      arrived.store(0, std::memory_order_relaxed);
+      batons[(i + 1) % 2].reset();
+      batons[i % 2].post();
+    }
+    co_await batons[i % 2];
+  }
+}
+
+// Returns the number of operations performed.
+static folly::coro::Task<size_t> do_bench() {
+  mutex_counter = 0;
+  ops_done = 0;
+  arrived = 0;
+
+  size_t per_task = op_count / task_count;
+  size_t rem = op_count % task_count;
+
+  std::vector<folly::coro::Task<void>> tasks;
+  tasks.reserve(task_count);
+  if (primitive == "mutex") {
+    folly::coro::Mutex mtx;
+    for (size_t i = 0; i < task_count; ++i) {
+      tasks.push_back(mutex_worker(mtx, i < rem ? per_task + 1 : per_task));
+    }
+    co_await folly::coro::collectAllRange(std::move(tasks));
+    if (mutex_counter != op_count) {
+      std::printf(
+        "FAIL: Expected %zu increments but got %zu\n", op_count, mutex_counter
+      );
+    }
+    co_return mutex_counter;
+  }
+  // Every task must arrive at each round, so all tasks run the same number of
+  // rounds and the remainder is dropped.
+  folly::coro::Baton batons[2];
+  for (size_t i = 0; i < task_count; ++i) {
+    tasks.push_back(event_worker(batons, per_task));
+  }
+  co_await folly::coro::collectAllRange(std::move(tasks));
+  if (ops_done != per_task * task_count) {
+    std::printf(
+      "FAIL: Expected %zu arrivals but got %zu\n", per_task * task_count,
+      ops_done.load()
+    );
+  }
+  co_return ops_done.load();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+    if (task_count == 0) {
+      task_count = 1;
+    }
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc > 3) {
+    primitive = argv[3];
+  }
+  if (primitive != "mutex" && primitive != "event") {
+    std::printf("Unknown primitive: %s\n", primitive.c_str());
+    std::printf("Usage: sync <task count> [thread count] [mutex|event]\n");
+    exit(1);
+  }
+
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+  std::printf("primitive: %s\n", primitive.c_str());
+  folly::CPUThreadPoolExecutor executor(thread_count);
+
+  {
+    auto result = folly::coro::blockingWait(
+      co_withExecutor(&executor, do_bench())); // warmup
+    std::printf("output: %zu\n", result);
+  }
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  size_t ops = 0;
+  for (size_t i = 0; i < iter_count; ++i) {
+    ops += folly::coro::blockingWait(co_withExecutor(&executor, do_bench()));
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  size_t opsPerSec = static_cast<size_t>(
+    static_cast<double>(ops) * 1000000.0 / static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    operations: %zu\n", ops);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    operations/sec: %zu\n", opsPerSec);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+  return 0;
+}
@@ -0,0 +1,154 @@
+// Test performance of the library's timers.
+// Many tasks each arm a sequence of short timers with random durations.
+// A fraction of the timers are cancelled immediately after being armed.
+// Reports timers/sec and a histogram of how late the fired timers resumed.
+// The workload is defined in 2common/timer.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "timer.hpp"
+
+#include <folly/CancellationToken.h>
+#include <folly/OperationCancelled.h>
+#include <folly/coro/BlockingWait.h>
+#include <folly/coro/Collect.h>
+#include <folly/coro/CurrentExecutor.h>
+#include <folly/coro/Sleep.h>
+#include <folly/coro/Task.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using std::chrono::steady_clock;
+
+static size_t task_count = 10000;
+
+// Returns true if the sleep was cancelled.
+static folly::coro::Task<bool> wait_timer(std::chrono::microseconds Delay) {
+  auto result = co_await folly::coro::co_awaitTry(folly::coro::sleep(Delay));
+  co_return result.hasException<folly::OperationCancelled>();
+}
+
+static folly::coro::Task<void>
+timer_task(folly::Executor* ex, size_t Task, timer_result& Result) {
+  size_t ops = timer_ops_for_task(Task, task_count);
+  for (size_t i = 0; i < ops; ++i) {
+    auto op = timer_make_op(Task, i);
+    auto delay = std::chrono::microseconds(op.duration_us);
+    if (op.cancel) {
+      // start() only enqueues the sleep on the executor. Rescheduling this
+      // task queues it behind the sleep on the single executor thread, so the
+      // sleep has been armed by the time it is cancelled.
+      folly::CancellationSource source;
+      auto wait =
+        folly::coro::co_withCancellation(source.getToken(), wait_timer(delay));
+      auto waiter = co_withExecutor(ex, std::move(wait)).start();
+      co_await folly::coro::co_reschedule_on_current_executor;
+      source.requestCancellation();
+      if (co_await std::move(waiter)) {
+        ++Result.cancelled;
+      } else {
+        ++Result.failed;
+      }
+    } else {
+      auto deadline = steady_clock::now() + delay;
+      co_await folly::coro::sleep(delay);
+      auto now = steady_clock::now();
+      ++Result.fired;
+      Result.lateness.record(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline)
+          .count()
+      ));
+    }
+  }
+}
+
+static folly::coro::Task<void>
+run_timers(folly::Executor* ex, std::vector<timer_result>& Results) {
+  std::vector<folly::coro::Task<void>> tasks;
+  tasks.reserve(task_count);
+  for (size_t i = 0; i < task_count; ++i) {
+    tasks.emplace_back(timer_task(ex, i, Results[i]));
+  }
+  co_await folly::coro::collectAllRange(std::move(tasks));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+  }
+
+  folly::CPUThreadPoolExecutor executor(1);
+  size_t expected_cancelled = timer_expected_cancelled(task_count);
+  std::vector<timer_result> results(task_count);
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  folly::coro::blockingWait(
+    co_withExecutor(&executor, run_timers(&executor, results))
+  );
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  timer_result total;
+  for (auto& r : results) {
+    total.merge(r);
+  }
+  if (total.failed != 0 || total.cancelled != expected_cancelled ||
+      total.fired + total.cancelled != timer_count) {
+    std::printf(
+      "FAIL: expected %zu fired and %zu cancelled but got %zu fired, %zu "
+      "cancelled, and %zu failed\n",
+      timer_count - expected_cancelled, expected_cancelled, total.fired,
+      total.cancelled, total.failed
+    );
+  }
+
+  std::printf("tasks: %zu\n", task_count);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    timers: %zu\n", timer_count);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf(
+    "    timers/sec: %zu\n",
+    static_cast<size_t>(timer_count * 1000000 / totalTimeUs)
+  );
+  std::printf("    cancelled: %zu\n", total.cancelled);
+  std::printf("    lateness_p50: %zu us\n", total.lateness.percentile_us(50.0));
+  std::printf("    lateness_p99: %zu us\n", total.lateness.percentile_us(99.0));
+  std::printf(
+    "    lateness_max: %zu us\n",
+    static_cast<size_t>(total.lateness.max_ns / 1000)
+  );
+  total.lateness.print_yaml("lateness");
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
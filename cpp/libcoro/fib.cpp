@@ -26,8 +26,10 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "coro/coro.hpp" // IWYU pragma: keep
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cinttypes>
@@ -43,8 +45,8 @@ static coro::task<size_t> fib(coro::thread_pool& tp, size_t n) {
   // of fib() invocations that are leaves avoid a schedule round-trip entirely.
   // Internal nodes still co_await tp.schedule() before forking, so both
   // children remain stealable and parallelism is unchanged.
-  if (n < 2)
-    co_return n;
+  if (n < fib_cutoff)
+    co_return fib_serial(n);
 
   co_await tp.schedule();
 
@@ -73,6 +75,7 @@ int main(int argc, char* argv[]) {
       co_await tp.schedule();
       auto result = co_await fib(tp, 30); // warmup
 
+      auto startCpu = utilization_now();
       auto startTime = std::chrono::high_resolution_clock::now();
 
       for (size_t i = 0; i < iter_count; ++i) {
@@ -81,12 +84,14 @@ int main(int argc, char* argv[]) {
       }
 
       auto endTime = std::chrono::high_resolution_clock::now();
+      auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
       auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
         endTime - startTime
       );
       std::printf("runs:\n");
       std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
       std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+      cpu.print_yaml();
       std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
       co_return 0;
     }(*tp, n)
@@ -0,0 +1,152 @@
+// Test performance of async generators.
+// Values are produced by a source generator and consumed through a chain of
+// nested transform / filter generators of configurable depth. Reports the
+// time and heap allocations per element.
+// The workload is defined in 2common/generator.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "alloc_count.hpp"
+#include "generator.hpp"
+#include "memusage.hpp"
+
+#include "coro/coro.hpp" // IWYU pragma: keep
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t depth = 4;
+static const size_t iter_count = 1;
+
+// libcoro's generator is synchronous, so the chain doesn't suspend between
+// elements. It serves as a baseline for the async generators.
+using generator = coro::generator<uint64_t>;
+
+static generator source() {
+  for (uint64_t i = 0; i < generator_element_count; ++i) {
+    uint64_t value = i;
+    co_yield value;
+  }
+}
+
+static generator transform(generator in) {
+  for (uint64_t item : in) {
+    uint64_t value = generator_transform(item);
+    co_yield value;
+  }
+}
+
+static generator filter(generator in) {
+  for (uint64_t value : in) {
+    if (generator_keep(value)) {
+      co_yield value;
+    }
+  }
+}
+
+static coro::task<generator_result> do_bench(coro::thread_pool& tp) {
+  co_await tp.schedule();
+  generator gen = source();
+  for (size_t stage = 0; stage < depth; ++stage) {
+    if (stage % 2 == 0) {
+      gen = transform(std::move(gen));
+    } else {
+      gen = filter(std::move(gen));
+    }
+  }
+  generator_result r{0, 0};
+  for (uint64_t value : gen) {
+    ++r.count;
+    r.sum += value;
+  }
+  co_return r;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    depth = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("depth: %zu\n", depth);
+  auto expected = generator_expected(depth);
+  coro::thread_pool::options opts;
+  opts.thread_count = static_cast<uint32_t>(thread_count);
+  auto tp = coro::thread_pool::make_unique(opts);
+
+  coro::sync_wait(do_bench(*tp)); // warmup
+
+  auto startAllocs = alloc_stats_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    auto result = coro::sync_wait(do_bench(*tp));
+    if (result != expected) {
+      std::printf(
+        "FAIL: Expected %zu elements with sum %" PRIu64
+        " but got %zu elements with sum %" PRIu64 "\n",
+        expected.count, expected.sum, result.count, result.sum
+      );
+    }
+    std::printf("output: %zu\n", result.count);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto endAllocs = alloc_stats_now();
+  auto totalTimeNs =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime)
+      .count();
+
+  size_t elements = generator_element_count * iter_count;
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    elements: %zu\n", elements);
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeNs / 1000)
+  );
+  std::printf(
+    "    elements/sec: %zu\n",
+    static_cast<size_t>(
+      static_cast<double>(elements) * 1000000000.0 /
+      static_cast<double>(totalTimeNs)
+    )
+  );
+  std::printf(
+    "    ns_per_element: %.2f\n",
+    static_cast<double>(totalTimeNs) / static_cast<double>(elements)
+  );
+  std::printf("    allocations: %zu\n", endAllocs.count - startAllocs.count);
+  std::printf("    alloc_bytes: %zu\n", endAllocs.bytes - startAllocs.bytes);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+  return 0;
+}
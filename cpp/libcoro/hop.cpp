@@ -0,0 +1,115 @@
+// Test the cost of moving a coroutine between a CPU executor and an I/O
+// executor. Each request hops back and forth the given number of times.
+// Reports hops/sec and the per-hop latency in each direction.
+// The workload is defined in 2common/hop.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "hop.hpp"
+#include "memusage.hpp"
+#include "coro/coro.hpp" // IWYU pragma: keep
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t hops = 2;
+
+static coro::task<void> request_loop(
+  coro::io_scheduler& Io, coro::thread_pool& Tp, size_t Loop, hop_stats& Stats
+) {
+  co_await Tp.schedule();
+  size_t requests = hop_requests_for_loop(Loop, hops);
+  for (size_t r = 0; r < requests; ++r) {
+    for (size_t h = 0; h < hops; h += 2) {
+      auto start = hop_stats::clock::now();
+      co_await Io.schedule();
+      Stats.arrived_io(start);
+      start = hop_stats::clock::now();
+      co_await Tp.schedule();
+      Stats.arrived_cpu(start);
+    }
+  }
+}
+
+static coro::task<void> run_all(
+  coro::io_scheduler& Io, coro::thread_pool& Tp, std::vector<hop_stats>& Stats
+) {
+  std::vector<coro::task<void>> tasks;
+  tasks.reserve(hop_concurrency);
+  for (size_t i = 0; i < hop_concurrency; ++i) {
+    tasks.emplace_back(request_loop(Io, Tp, i, Stats[i]));
+  }
+  co_await coro::when_all(std::move(tasks));
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    hops = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  // Each request must finish on the CPU executor.
+  hops = hops < 2 ? 2 : hops / 2 * 2;
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("hops: %zu\n", hops);
+  auto tp = coro::thread_pool::make_unique(coro::thread_pool::options{
+    .thread_count = static_cast<uint32_t>(thread_count)
+  });
+  // Process tasks on the io_scheduler's own thread rather than handing them
+  // to an internal thread pool.
+  auto io = coro::io_scheduler::make_unique(coro::io_scheduler::options{
+    .execution_strategy =
+      coro::io_scheduler::execution_strategy_t::process_tasks_inline
+  });
+  coro::sync_wait([](coro::io_scheduler& Io) -> coro::task<void> {
+    co_await Io.schedule();
+    hop_io_thread = std::this_thread::get_id();
+  }(*io));
+
+  std::vector<hop_stats> stats(hop_concurrency);
+  auto startTime = std::chrono::high_resolution_clock::now();
+  coro::sync_wait(run_all(*io, *tp, stats));
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  hop_stats total;
+  for (auto& s : stats) {
+    total.merge(s);
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  total.print_yaml(hops, totalTimeUs);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
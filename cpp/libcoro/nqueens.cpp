@@ -11,7 +11,9 @@
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "coro/coro.hpp" // IWYU pragma: keep
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 
 #include <array>
 #include <cinttypes>
@@ -40,8 +42,8 @@ template <size_t N>
 coro::task<int>
 nqueens(coro::thread_pool& tp, int xMax, std::array<char, N> buf) {
   // Only reschedule onto the pool for internal nodes that actually fan out.
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   co_await tp.schedule();
@@ -91,6 +93,7 @@ int main(int argc, char* argv[]) {
       check_answer(result);
     }
 
+    auto startCpu = utilization_now();
     auto startTime = std::chrono::high_resolution_clock::now();
 
     for (size_t i = 0; i < iter_count; ++i) {
@@ -101,12 +104,14 @@ int main(int argc, char* argv[]) {
     }
 
     auto endTime = std::chrono::high_resolution_clock::now();
+    auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
     auto totalTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
       endTime - startTime
     );
     std::printf("runs:\n");
     std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
     std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+    cpu.print_yaml();
     std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
     co_return 0;
   }(*tp));
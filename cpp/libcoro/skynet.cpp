@@ -28,8 +28,10 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
 #include "coro/coro.hpp" // IWYU pragma: keep
+#include "utilization.hpp"
 
 #include <chrono>
 #include <cinttypes>
@@ -45,8 +47,8 @@ coro::task<size_t>
 skynet_one(coro::thread_pool& tp, size_t BaseNum, size_t Depth) {
   co_await tp.schedule();
 
-  if (Depth == DepthMax) {
-    co_return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    co_return skynet_serial(BaseNum, DepthMax - Depth);
   }
 
   size_t depthOffset = 1;
@@ -77,15 +79,18 @@ template <size_t DepthMax> coro::task<void> skynet(coro::thread_pool& tp) {
 template <size_t Depth = 6>
 coro::task<void> loop_skynet(coro::thread_pool& tp) {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     co_await skynet<Depth>(tp);
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -13,15 +13,19 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "two_pools.hpp"
+#include "utilization.hpp"
 #include <libfork.hpp>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 
 inline constexpr auto fib = [](auto fib, size_t n) -> lf::task<size_t> {
-  if (n < 2) {
-    co_return n;
+  if (n < fib_cutoff) {
+    co_return fib_serial(n);
   }
 
   size_t x, y;
@@ -34,6 +38,26 @@ inline constexpr auto fib = [](auto fib, size_t n) -> lf::task<size_t> {
   co_return x + y;
 };
 
+// Runs fib(n) on two pools at once, each with half of the threads.
+static void run_two_pools(size_t n) {
+  lf::lazy_pool pool0(two_pools_threads(thread_count, 0));
+  lf::lazy_pool pool1(two_pools_threads(thread_count, 1));
+  lf::lazy_pool* pools[2] = {&pool0, &pool1};
+  size_t results[2];
+  for (size_t i = 0; i < 2; ++i) {
+    results[i] = lf::sync_wait(*pools[i], fib, 30); // warmup
+  }
+
+  auto result = two_pools_run([&](size_t Pool) {
+    results[Pool] = lf::sync_wait(*pools[Pool], fib, n);
+  });
+  std::printf("output: %zu %zu\n", results[0], results[1]);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  result.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
 int main(int argc, char* argv[]) {
   if (argc > 2) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
@@ -45,10 +69,15 @@ int main(int argc, char* argv[]) {
   size_t n = static_cast<size_t>(atoi(argv[1]));
 
   std::printf("threads: %" PRIu64 "\n", thread_count);
+  if (argc > 3 && strcmp(argv[3], "2pool") == 0) {
+    run_two_pools(n);
+    return 0;
+  }
   lf::lazy_pool pool(thread_count);
 
   auto result = lf::sync_wait(pool, fib, 30); // warmup
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -57,11 +86,13 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
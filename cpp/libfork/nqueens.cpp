@@ -14,7 +14,9 @@
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "utilization.hpp"
 #include <libfork.hpp>
 #include <ranges>
 
@@ -50,8 +52,8 @@ inline auto queens_ok(int n, char* a) -> bool {
 constexpr auto nqueens =
   []<std::size_t N>(auto nqueens, int xMax, std::array<char, N> buf)
     LF_STATIC_CALL -> lf::task<int> {
-  if (N == xMax) {
-    co_return 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
   }
 
   auto ys = std::ranges::views::iota(0UL, N) |
@@ -99,6 +101,7 @@ int main(int argc, char* argv[]) {
     check_answer(result);
   }
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -110,11 +113,13 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
   return 0;
 }
@@ -0,0 +1,123 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Find-first variant: stops all outstanding work once the single matching
+// solution defined in 2common/nqueens_first.hpp is found.
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include "memusage.hpp"
+#include "nqueens_first.hpp"
+#include <libfork.hpp>
+#include <ranges>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+// libfork has no task cancellation, so this uses a shared flag. A task stops
+// forking children once the flag is set, but must still join the children it
+// already forked.
+constexpr auto nqueens_first =
+  []<std::size_t N>(
+    auto nqueens_first, int xMax, std::array<char, N> buf,
+    nqueens_first_state* State
+  ) LF_STATIC_CALL -> lf::task<void> {
+  if (State->found()) {
+    co_return;
+  }
+  if (N == xMax) {
+    uint64_t hash = nqueens_first_hash(buf);
+    if (nqueens_first_match(hash)) {
+      State->publish(hash);
+    }
+    co_return;
+  }
+
+  auto ys = std::ranges::views::iota(0UL, N) |
+            std::ranges::views::filter([xMax, &buf](int y) {
+              char q = y;
+              for (int x = 0; x < xMax; x++) {
+                char p = buf[x];
+                if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+                  return false;
+                }
+              }
+              return true;
+            });
+
+  for (auto y : ys) {
+    if (State->found()) {
+      break;
+    }
+    buf[xMax] = y;
+    co_await lf::fork[nqueens_first](xMax + 1, buf, State);
+  }
+
+  co_await lf::join;
+};
+
+static void check_answer(const nqueens_first_state& State) {
+  if (!State.found() || State.answer != nqueens_first_answer) {
+    std::printf(
+      "FAIL: expected %" PRIu64 ", got %" PRIu64 "\n", nqueens_first_answer,
+      State.answer
+    );
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  lf::lazy_pool pool(thread_count);
+  {
+    nqueens_first_state state;
+    std::array<char, nqueens_first_work> buf{};
+    lf::sync_wait(pool, nqueens_first, 0, buf, &state); // warmup
+    check_answer(state);
+  }
+
+  size_t answerUs = 0;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    nqueens_first_state state;
+    std::array<char, nqueens_first_work> buf{};
+    auto iterStart = std::chrono::steady_clock::now();
+    lf::sync_wait(pool, nqueens_first, 0, buf, &state);
+    check_answer(state);
+    answerUs += static_cast<size_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        state.found_at - iterStart
+      )
+        .count()
+    );
+    std::printf("output: %" PRIu64 "\n", state.answer);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf("    time_to_answer: %zu us\n", answerUs);
+  std::printf("    drain: %zu us\n", totalTimeUs - answerUs);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+  return 0;
+}
@@ -28,13 +28,17 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "two_pools.hpp"
+#include "utilization.hpp"
 #include <libfork.hpp>
 
 #include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
@@ -42,8 +46,8 @@ static const size_t iter_count = 1;
 template <size_t DepthMax>
 inline constexpr auto skynet_one =
   [](auto skynet_one, size_t BaseNum, size_t Depth) -> lf::task<size_t> {
-  if (Depth == DepthMax) {
-    co_return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    co_return skynet_serial(BaseNum, DepthMax - Depth);
   }
   size_t depthOffset = 1;
   for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
@@ -83,23 +87,48 @@ inline constexpr auto skynet = [](auto skynet) -> lf::task<void> {
 template <size_t Depth = 6>
 inline constexpr auto loop_skynet = [](auto loop_skynet) -> lf::task<void> {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     co_await lf::just[skynet<Depth>]();
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 };
 
+// Runs skynet on two pools at once, each with half of the threads.
+template <size_t Depth = 6> void run_two_pools() {
+  lf::lazy_pool pool0(two_pools_threads(thread_count, 0));
+  lf::lazy_pool pool1(two_pools_threads(thread_count, 1));
+  lf::lazy_pool* pools[2] = {&pool0, &pool1};
+  for (size_t i = 0; i < 2; ++i) {
+    lf::sync_wait(*pools[i], skynet<Depth>); // warmup
+  }
+
+  auto result = two_pools_run([&](size_t Pool) {
+    lf::sync_wait(*pools[Pool], skynet<Depth>);
+  });
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  result.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
 int main(int argc, char* argv[]) {
   if (argc > 1) {
     thread_count = static_cast<size_t>(atoi(argv[1]));
   }
   std::printf("threads: %" PRIu64 "\n", thread_count);
+  if (argc > 2 && strcmp(argv[2], "2pool") == 0) {
+    run_two_pools<8>();
+    return 0;
+  }
   lf::lazy_pool pool(thread_count);
   lf::sync_wait(pool, skynet<8>); // warmup
   lf::sync_wait(pool, loop_skynet<8>);
@@ -0,0 +1,99 @@
+// An implementation of the recursive fork fibonacci parallelism test.
+
+// Adapted from https://github.com/tzcnt/tmc-examples/blob/main/examples/fib.cpp
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+#include "utilization.hpp"
+#include <omp.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+size_t fib(size_t n) {
+  if (n < fib_cutoff)
+    return fib_serial(n);
+
+  size_t x, y;
+#pragma omp task shared(x)
+  x = fib(n - 1);
+  y = fib(n - 2);
+#pragma omp taskwait
+
+  return x + y;
+}
+
+// Runs fib(n) on the thread team, from a single thread that spawns the root.
+static size_t run_fib(size_t n) {
+  size_t result;
+#pragma omp parallel
+#pragma omp single
+  result = fib(n);
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc < 2) {
+    printf("Usage: fib <n-th fibonacci number requested>\n");
+    exit(0);
+  }
+  size_t n = static_cast<size_t>(atoi(argv[1]));
+
+  std::printf("threads: %zu\n", thread_count);
+  omp_set_dynamic(0);
+  omp_set_num_threads(static_cast<int>(thread_count));
+
+  size_t result = run_fib(30); // warmup
+
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    result = run_fib(n);
+    std::printf("output: %zu\n", result);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -0,0 +1,110 @@
+// An implementation of recursive matrix multiplication
+
+// Adapted from
+// https://github.com/mtmucha/coros/blob/main/benchmarks/coros_mat.h
+
+// Original author: mtmucha
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "matmul.hpp"
+#include "memusage.hpp"
+#include "utilization.hpp"
+#include <omp.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+
+template <typename T> void matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
+    // Base case: Use simple triple-loop multiplication for small matrices
+    matmul_small(t, N);
+  } else {
+    // Recursive case: Divide the matrices into 4 submatrices and multiply them
+    auto s = matmul_split(t, N);
+
+    // Split the execution into 2 sections to ensure output locations are not
+    // written in parallel
+#pragma omp task
+    matmul(s[0], N);
+#pragma omp task
+    matmul(s[1], N);
+#pragma omp task
+    matmul(s[2], N);
+    matmul(s[3], N);
+#pragma omp taskwait
+
+#pragma omp task
+    matmul(s[4], N);
+#pragma omp task
+    matmul(s[5], N);
+#pragma omp task
+    matmul(s[6], N);
+    matmul(s[7], N);
+#pragma omp taskwait
+  }
+}
+
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  matmul_matrices<T>& M, utilization_result* Cpu = nullptr
+) {
+  M.init();
+
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+#pragma omp parallel
+#pragma omp single
+  matmul(M.tile(), M.N);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
+}
+
+template <typename T> void run_one(int N) {
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(m, &cpu);
+  m.validate();
+  std::printf("  - matrix_size: %d\n", N);
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc < 2) {
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
+    exit(0);
+  }
+  // The config selects the base case kernel and the element type.
+  matmul_args args = matmul_parse_args(argc, argv);
+  std::printf("threads: %zu\n", thread_count);
+  omp_set_dynamic(0);
+  omp_set_num_threads(static_cast<int>(thread_count));
+
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(warmup);
+    }
+
+    std::printf("runs:\n");
+
+    run_one<T>(args.n);
+  });
+}
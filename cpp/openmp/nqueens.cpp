@@ -0,0 +1,116 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+#include "utilization.hpp"
+#include <omp.h>
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+inline constexpr int nqueens_work = 14;
+
+inline constexpr std::array<int, 28> answers = {
+  0,       1,         0,          0,          2,           10,     4,
+  40,      92,        352,        724,        2'680,       14'200, 73'712,
+  365'596, 2'279'184, 14'772'512, 95'815'104, 666'090'624,
+};
+
+void check_answer(int result) {
+  if (result != answers[nqueens_work]) {
+    std::printf("error: expected %d, got %d\n", answers[nqueens_work], result);
+  }
+}
+
+
+template <size_t N> int nqueens(int xMax, std::array<char, N> buf) {
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    return nqueens_serial(xMax, buf);
+  }
+
+  std::array<int, N> results;
+  size_t taskCount = 0;
+  for (int y = 0; y < static_cast<int>(N); ++y) {
+    char q = static_cast<char>(y);
+    bool legal = true;
+    for (int x = 0; x < xMax; ++x) {
+      char p = buf[x];
+      if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+        legal = false;
+        break;
+      }
+    }
+    if (legal) {
+      buf[xMax] = q;
+      size_t i = taskCount++;
+      // buf is copied into the task when it's created
+#pragma omp task shared(results)
+      results[i] = nqueens(xMax + 1, buf);
+    }
+  }
+#pragma omp taskwait
+
+  int ret = 0;
+  for (size_t i = 0; i < taskCount; ++i) {
+    ret += results[i];
+  }
+
+  return ret;
+};
+
+// Runs nqueens on the thread team, from a single thread that spawns the root.
+static int run_nqueens() {
+  std::array<char, nqueens_work> buf{};
+  int result;
+#pragma omp parallel
+#pragma omp single
+  result = nqueens(0, buf);
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  omp_set_dynamic(0);
+  omp_set_num_threads(static_cast<int>(thread_count));
+
+  check_answer(run_nqueens()); // warmup
+
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    int result = run_nqueens();
+    check_answer(result);
+    std::printf("output: %d\n", result);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
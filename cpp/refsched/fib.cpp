@@ -0,0 +1,113 @@
+// An implementation of the recursive fork fibonacci parallelism test.
+
+// Adapted from https://github.com/tzcnt/tmc-examples/blob/main/examples/fib.cpp
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+#include "refsched.hpp"
+#include "utilization.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+size_t fibonacci(size_t n) {
+  if (n < fib_cutoff)
+    return fib_serial(n);
+
+  size_t x, y;
+
+  refsched_task_group tg;
+  tg.run([&] { x = fibonacci(n - 1); });
+  y = fibonacci(n - 2);
+  tg.wait();
+
+  return x + y;
+}
+
+refsched_coro<size_t> fib_coro(size_t n) {
+  if (n < fib_cutoff)
+    co_return fib_serial(n);
+
+  size_t x, y;
+
+  refsched_fork_group fg;
+  fg.fork(fib_coro(n - 1), &x);
+  fg.fork(fib_coro(n - 2), &y);
+  co_await fg;
+
+  co_return x + y;
+}
+
+static size_t run_fib(refsched_pool& pool, size_t n) {
+  if (pool.options().task == refsched_task::CORO) {
+    return pool.run(fib_coro(n));
+  }
+  size_t result;
+  pool.run([&] { result = fibonacci(n); });
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc < 2) {
+    printf("Usage: fib <n-th fibonacci number requested>\n");
+    exit(0);
+  }
+  size_t n = static_cast<size_t>(atoi(argv[1]));
+  // The config selects the scheduler's design choices; see refsched.hpp.
+  refsched_options opts = refsched_parse_config(argc, argv, 3);
+
+  std::printf("threads: %zu\n", thread_count);
+  refsched_pool pool(thread_count, opts);
+
+  size_t result = run_fib(pool, 30); // warmup
+
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    result = run_fib(pool, n);
+    std::printf("output: %zu\n", result);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
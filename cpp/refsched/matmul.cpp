@@ -0,0 +1,129 @@
+// An implementation of recursive matrix multiplication
+
+// Adapted from
+// https://github.com/mtmucha/coros/blob/main/benchmarks/coros_mat.h
+
+// Original author: mtmucha
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "matmul.hpp"
+#include "memusage.hpp"
+#include "refsched.hpp"
+#include "utilization.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+
+template <typename T> void matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
+    // Base case: Use simple triple-loop multiplication for small matrices
+    matmul_small(t, N);
+  } else {
+    // Recursive case: Divide the matrices into 4 submatrices and multiply them
+    auto s = matmul_split(t, N);
+
+    // Split the execution into 2 sections to ensure output locations are not
+    // written in parallel
+    refsched_task_group tg;
+    tg.run([&]() { matmul(s[0], N); });
+    tg.run([&]() { matmul(s[1], N); });
+    tg.run([&]() { matmul(s[2], N); });
+    matmul(s[3], N);
+    tg.wait();
+
+    tg.run([&]() { matmul(s[4], N); });
+    tg.run([&]() { matmul(s[5], N); });
+    tg.run([&]() { matmul(s[6], N); });
+    matmul(s[7], N);
+    tg.wait();
+  }
+}
+
+template <typename T> refsched_coro<void> matmul_coro(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
+    matmul_small(t, N);
+  } else {
+    auto s = matmul_split(t, N);
+
+    refsched_fork_group fg;
+    fg.fork(matmul_coro(s[0], N));
+    fg.fork(matmul_coro(s[1], N));
+    fg.fork(matmul_coro(s[2], N));
+    fg.fork(matmul_coro(s[3], N));
+    co_await fg;
+
+    fg.fork(matmul_coro(s[4], N));
+    fg.fork(matmul_coro(s[5], N));
+    fg.fork(matmul_coro(s[6], N));
+    fg.fork(matmul_coro(s[7], N));
+    co_await fg;
+  }
+}
+
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  refsched_pool& executor, matmul_matrices<T>& M,
+  utilization_result* Cpu = nullptr
+) {
+  M.init();
+
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  if (executor.options().task == refsched_task::CORO) {
+    executor.run(matmul_coro(M.tile(), M.N));
+  } else {
+    executor.run([&] { matmul(M.tile(), M.N); });
+  }
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
+}
+
+template <typename T> void run_one(refsched_pool& executor, int N) {
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(executor, m, &cpu);
+  m.validate();
+  std::printf("  - matrix_size: %d\n", N);
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  if (argc < 2) {
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
+    exit(0);
+  }
+  // The config selects the scheduler's design choices (see refsched.hpp), and
+  // the base case kernel and the element type.
+  refsched_options opts = refsched_parse_config(argc, argv, 3, false);
+  matmul_args args = matmul_parse_args(argc, argv);
+  std::printf("threads: %zu\n", thread_count);
+  refsched_pool executor(thread_count, opts);
+
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(executor, warmup);
+    }
+
+    std::printf("runs:\n");
+
+    run_one<T>(executor, args.n);
+  });
+}
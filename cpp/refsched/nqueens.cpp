@@ -0,0 +1,160 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+#include "refsched.hpp"
+#include "utilization.hpp"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+inline constexpr int nqueens_work = 14;
+
+inline constexpr std::array<int, 28> answers = {
+  0,       1,         0,          0,          2,           10,     4,
+  40,      92,        352,        724,        2'680,       14'200, 73'712,
+  365'596, 2'279'184, 14'772'512, 95'815'104, 666'090'624,
+};
+
+void check_answer(int result) {
+  if (result != answers[nqueens_work]) {
+    std::printf("error: expected %d, got %d\n", answers[nqueens_work], result);
+  }
+}
+
+// The number of legal positions for the next queen, stored into Ys.
+template <size_t N>
+static size_t nqueens_children(
+  int xMax, const std::array<char, N>& buf, std::array<char, N>& Ys
+) {
+  size_t count = 0;
+  for (int y = 0; y < static_cast<int>(N); ++y) {
+    char q = static_cast<char>(y);
+    bool legal = true;
+    for (int x = 0; x < xMax; ++x) {
+      char p = buf[x];
+      if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+        legal = false;
+        break;
+      }
+    }
+    if (legal) {
+      Ys[count++] = q;
+    }
+  }
+  return count;
+}
+
+template <size_t N> int nqueens(int xMax, std::array<char, N> buf) {
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    return nqueens_serial(xMax, buf);
+  }
+
+  std::array<char, N> ys;
+  size_t taskCount = nqueens_children(xMax, buf, ys);
+  if (taskCount == 0) {
+    return 0;
+  }
+
+  std::array<int, N> results;
+  refsched_task_group tg;
+  // Spawn all children except the last, which runs inline.
+  for (size_t i = 0; i + 1 < taskCount; ++i) {
+    buf[xMax] = ys[i];
+    tg.run([xMax, buf, i, &results]() {
+      results[i] = nqueens(xMax + 1, buf);
+    });
+  }
+  buf[xMax] = ys[taskCount - 1];
+  results[taskCount - 1] = nqueens(xMax + 1, buf);
+  tg.wait();
+
+  int ret = 0;
+  for (size_t i = 0; i < taskCount; ++i) {
+    ret += results[i];
+  }
+
+  return ret;
+};
+
+template <size_t N>
+refsched_coro<int> nqueens_coro(int xMax, std::array<char, N> buf) {
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    co_return nqueens_serial(xMax, buf);
+  }
+
+  std::array<char, N> ys;
+  size_t taskCount = nqueens_children(xMax, buf, ys);
+
+  std::array<int, N> results;
+  refsched_fork_group fg;
+  for (size_t i = 0; i < taskCount; ++i) {
+    buf[xMax] = ys[i];
+    fg.fork(nqueens_coro(xMax + 1, buf), &results[i]);
+  }
+  co_await fg;
+
+  int ret = 0;
+  for (size_t i = 0; i < taskCount; ++i) {
+    ret += results[i];
+  }
+
+  co_return ret;
+};
+
+static int run_nqueens(refsched_pool& pool) {
+  std::array<char, nqueens_work> buf{};
+  if (pool.options().task == refsched_task::CORO) {
+    return pool.run(nqueens_coro(0, buf));
+  }
+  int result;
+  pool.run([&] { result = nqueens(0, buf); });
+  return result;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  // The config selects the scheduler's design choices; see refsched.hpp.
+  refsched_options opts = refsched_parse_config(argc, argv, 2);
+  std::printf("threads: %zu\n", thread_count);
+  refsched_pool pool(thread_count, opts);
+
+  check_answer(run_nqueens(pool)); // warmup
+
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    int result = run_nqueens(pool);
+    check_answer(result);
+    std::printf("output: %d\n", result);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
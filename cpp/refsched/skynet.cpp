@@ -0,0 +1,141 @@
+// The skynet benchmark as described here:
+// https://github.com/atemerev/skynet
+
+// Adapted from
+// https://github.com/tzcnt/tmc-examples/blob/main/examples/skynet/main.cpp
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+#include "refsched.hpp"
+#include "utilization.hpp"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+template <size_t DepthMax> size_t skynet_one(size_t BaseNum, size_t Depth) {
+  if (DepthMax - Depth <= skynet_cutoff) {
+    return skynet_serial(BaseNum, DepthMax - Depth);
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
+    depthOffset *= 10;
+  }
+
+  std::array<size_t, 10> results;
+
+  refsched_task_group tg;
+  for (size_t i = 0; i < 9; ++i) {
+    tg.run([=, &results, idx = i]() {
+      results[idx] =
+        skynet_one<DepthMax>(BaseNum + depthOffset * idx, Depth + 1);
+    });
+  }
+  results[9] = skynet_one<DepthMax>(BaseNum + depthOffset * 9, Depth + 1);
+  tg.wait();
+
+  size_t count = 0;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    count += results[idx];
+  }
+  return count;
+}
+
+template <size_t DepthMax>
+refsched_coro<size_t> skynet_coro(size_t BaseNum, size_t Depth) {
+  if (DepthMax - Depth <= skynet_cutoff) {
+    co_return skynet_serial(BaseNum, DepthMax - Depth);
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
+    depthOffset *= 10;
+  }
+
+  std::array<size_t, 10> results;
+
+  refsched_fork_group fg;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    fg.fork(
+      skynet_coro<DepthMax>(BaseNum + depthOffset * idx, Depth + 1),
+      &results[idx]
+    );
+  }
+  co_await fg;
+
+  size_t count = 0;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    count += results[idx];
+  }
+  co_return count;
+}
+
+template <size_t DepthMax> void skynet(refsched_pool& pool) {
+  size_t count;
+  if (pool.options().task == refsched_task::CORO) {
+    count = pool.run(skynet_coro<DepthMax>(0, 0));
+  } else {
+    pool.run([&] { count = skynet_one<DepthMax>(0, 0); });
+  }
+  if (count != 4999999950000000) {
+    std::printf("ERROR: wrong result - %" PRIu64 "\n", count);
+  }
+}
+
+template <size_t Depth = 6> void loop_skynet(refsched_pool& pool) {
+  std::printf("runs:\n");
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  for (size_t j = 0; j < iter_count; ++j) {
+    skynet<Depth>(pool);
+  }
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  // The config selects the scheduler's design choices; see refsched.hpp.
+  refsched_options opts = refsched_parse_config(argc, argv, 2);
+  std::printf("threads: %zu\n", thread_count);
+  refsched_pool pool(thread_count, opts);
+
+  skynet<8>(pool); // warmup
+  loop_skynet<8>(pool);
+}
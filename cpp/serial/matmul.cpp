@@ -0,0 +1,76 @@
+// An implementation of recursive matrix multiplication
+
+// Adapted from
+// https://github.com/mtmucha/coros/blob/main/benchmarks/coros_mat.h
+
+// Original author: mtmucha
+// Distributed under the Boost Software License, Version 1.0. (See accompanying
+// file LICENSE or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// The serial elision: the 8 sub-multiplications are plain function calls,
+// run in order.
+
+#include "matmul.hpp"
+#include "memusage.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+template <typename T> void matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
+    matmul_small(t, N);
+  } else {
+    auto s = matmul_split(t, N);
+    for (auto& sub : s) {
+      matmul(sub, N);
+    }
+  }
+}
+
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(matmul_matrices<T>& M) {
+  M.init();
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  matmul(M.tile(), M.N);
+  auto endTime = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
+}
+
+template <typename T> void run_one(int N) {
+  matmul_matrices<T> m(N);
+  auto totalTimeUs = run_matmul(m);
+  m.validate();
+  std::printf("  - matrix_size: %d\n", N);
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
+    exit(0);
+  }
+  // The config selects the base case kernel and the element type, as for the
+  // other runtimes. The thread count is ignored and "firsttouch" has no
+  // effect, since everything runs on the calling thread.
+  matmul_args args = matmul_parse_args(argc, argv);
+  std::printf("threads: 1\n");
+
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(warmup);
+    }
+
+    std::printf("runs:\n");
+
+    run_one<T>(args.n);
+  });
+}
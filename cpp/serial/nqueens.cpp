@@ -0,0 +1,76 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// The serial elision: each legal child position is searched by a plain
+// function call instead of a task.
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+static const size_t iter_count = 1;
+
+inline constexpr int nqueens_work = 14;
+
+inline constexpr std::array<int, 28> answers = {
+  0,       1,         0,          0,          2,           10,     4,
+  40,      92,        352,        724,        2'680,       14'200, 73'712,
+  365'596, 2'279'184, 14'772'512, 95'815'104, 666'090'624,
+};
+
+void check_answer(int result) {
+  if (result != answers[nqueens_work]) {
+    std::printf("error: expected %d, got %d\n", answers[nqueens_work], result);
+  }
+}
+
+// nqueens_serial() is a pure function, so the input is read through a volatile
+// for each call and this isn't inlined; otherwise the compiler may merge the
+// timed call with the warmup.
+static volatile int start_row = 0;
+
+[[gnu::noinline]] static int nqueens(std::array<char, nqueens_work> buf) {
+  return nqueens_serial(start_row, buf);
+}
+
+int main() {
+  // The thread count and config arguments are accepted for compatibility with
+  // the other runtimes, but this always runs on the calling thread.
+  std::printf("threads: 1\n");
+
+  {
+    std::array<char, nqueens_work> buf{};
+    check_answer(nqueens(buf));
+  }
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    std::array<char, nqueens_work> buf{};
+    int result = nqueens(buf);
+    check_answer(result);
+    std::printf("output: %d\n", result);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
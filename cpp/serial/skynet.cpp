@@ -0,0 +1,76 @@
+// The skynet benchmark as described here:
+// https://github.com/atemerev/skynet
+// Each of the 10 children is summed by a plain function call instead of a
+// task.
+
+// Adapted from
+// https://github.com/tzcnt/tmc-examples/blob/main/examples/skynet/main.cpp
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "cutoff.hpp"
+#include "memusage.hpp"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+static const size_t iter_count = 1;
+
+// skynet_serial() is a pure function, so the input is read through a volatile
+// for each call and this isn't inlined; otherwise the compiler may merge the
+// timed call with the warmup.
+static volatile size_t base_num = 0;
+
+template <size_t DepthMax> [[gnu::noinline]] void skynet() {
+  size_t count = skynet_serial(base_num, DepthMax);
+  if (count != 4999999950000000) {
+    std::printf("ERROR: wrong result - %" PRIu64 "\n", count);
+  }
+}
+
+template <size_t Depth = 6> void loop_skynet() {
+  std::printf("runs:\n");
+  auto startTime = std::chrono::high_resolution_clock::now();
+  for (size_t j = 0; j < iter_count; ++j) {
+    skynet<Depth>();
+  }
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+  std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
+  std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+int main() {
+  // The thread count and config arguments are accepted for compatibility with
+  // the other runtimes, but this always runs on the calling thread.
+  std::printf("threads: 1\n");
+
+  skynet<8>(); // warmup
+  loop_skynet<8>();
+}
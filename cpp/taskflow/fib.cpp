@@ -4,7 +4,10 @@
 // https://github.com/taskflow/taskflow/blob/v3.9.0/examples/fibonacci.cpp
 // Original author: taskflow
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "trace_observer.hpp"
+#include "utilization.hpp"
 #include <taskflow/taskflow.hpp>
 
 #include <chrono>
@@ -19,8 +22,8 @@ static const size_t iter_count = 1;
 std::optional<tf::Executor> executor;
 
 size_t fib(size_t n) {
-  if (n < 2) {
-    return n;
+  if (n < fib_cutoff) {
+    return fib_serial(n);
   }
 
   tf::TaskGroup tg = executor->task_group();
@@ -45,6 +48,7 @@ int main(int argc, char* argv[]) {
   size_t n = static_cast<size_t>(atoi(argv[1]));
 
   executor.emplace(thread_count);
+  trace_observe(*executor);
 
   std::printf("threads: %zu\n", thread_count);
 
@@ -52,6 +56,7 @@ int main(int argc, char* argv[]) {
 
   executor->async([&result, n]() { result = fib(n); }).get();
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -61,10 +66,12 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
@@ -9,88 +9,79 @@
 
 #include "matmul.hpp"
 #include "memusage.hpp"
+#include "trace_observer.hpp"
+#include "utilization.hpp"
 #include <taskflow/algorithm/for_each.hpp>
 #include <taskflow/taskflow.hpp>
 
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
-#include <exception>
 #include <optional>
-#include <vector>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 std::optional<tf::Executor> executor;
 
-void matmul(int* a, int* b, int* c, int n, int N) {
-  if (n <= 32) {
+template <typename T> void matmul(matmul_tile<T> t, int N) {
+  if (matmul_is_leaf(t)) {
     // Base case: Use simple triple-loop multiplication for small matrices
-    matmul_small(a, b, c, n, N);
+    matmul_small(t, N);
   } else {
     // Recursive case: Divide the matrices into 4 submatrices and multiply them
-    int k = n / 2;
+    auto s = matmul_split(t, N);
 
     tf::TaskGroup tg = executor->task_group();
     // Split the execution into 2 sections to ensure output locations are not
     // written in parallel
-    tg.silent_async([=]() { matmul(a, b, c, k, N); });
-    tg.silent_async([=]() { matmul(a, b + k, c + k, k, N); });
-    tg.silent_async([=]() { matmul(a + k * N, b, c + k * N, k, N); });
+    tg.silent_async([t = s[0], N]() { matmul(t, N); });
+    tg.silent_async([t = s[1], N]() { matmul(t, N); });
+    tg.silent_async([t = s[2], N]() { matmul(t, N); });
     // Compute one branch synchronously
-    matmul(a + k * N, b + k, c + k * N + k, k, N);
+    matmul(s[3], N);
     tg.corun();
 
-    tg.silent_async([=]() { matmul(a + k, b + k * N, c, k, N); });
-    tg.silent_async([=]() { matmul(a + k, b + k * N + k, c + k, k, N); });
-    tg.silent_async([=]() {
-      matmul(a + k * N + k, b + k * N, c + k * N, k, N);
-    });
+    tg.silent_async([t = s[4], N]() { matmul(t, N); });
+    tg.silent_async([t = s[5], N]() { matmul(t, N); });
+    tg.silent_async([t = s[6], N]() { matmul(t, N); });
     // Compute one branch synchronously
-    matmul(a + k * N + k, b + k * N + k, c + k * N + k, k, N);
+    matmul(s[7], N);
     tg.corun();
   }
 }
 
-std::vector<int> run_matmul(tf::Executor& executor, int N) {
-  std::vector<int> A(N * N, 1);
-  std::vector<int> B(N * N, 1);
-  std::vector<int> C(N * N, 0);
+// Returns the duration of the multiplication, excluding initialization.
+template <typename T>
+std::chrono::microseconds run_matmul(
+  tf::Executor& executor, matmul_matrices<T>& M,
+  utilization_result* Cpu = nullptr
+) {
+  M.init();
 
-  int* a = A.data();
-  int* b = B.data();
-  int* c = C.data();
-
-  executor.async([=]() { matmul(a, b, c, N, N); }).get();
-  return C;
-}
-
-void validate_result(std::vector<int>& C, int N) {
-  std::atomic_thread_fence(std::memory_order_seq_cst);
-  int* c = C.data();
-  for (int i = 0; i < N; i++) {
-    for (int j = 0; j < N; j++) {
-      auto res = c[i * N + j];
-      if (res != N) {
-        std::printf(
-          "Wrong result at (%d,%d) : %d. expected %d\n", i, j, res, N
-        );
-        std::fflush(stdout);
-        std::terminate();
-      }
-    }
+  auto startCpu = utilization_now();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  matmul_tile<T> t = M.tile();
+  int N = M.N;
+  executor.async([=]() { matmul(t, N); }).get();
+  auto endTime = std::chrono::high_resolution_clock::now();
+  if (Cpu != nullptr) {
+    *Cpu = utilization_between(startCpu, utilization_now(), thread_count);
   }
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    endTime - startTime
+  );
 }
 
-void run_one(tf::Executor& executor, int N) {
-  auto startTime = std::chrono::high_resolution_clock::now();
-  std::vector<int> result = run_matmul(executor, N);
-  auto endTime = std::chrono::high_resolution_clock::now();
-  validate_result(result, N);
-  auto totalTimeUs =
-    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+template <typename T> void run_one(tf::Executor& executor, int N) {
+  matmul_matrices<T> m(N);
+  utilization_result cpu;
+  auto totalTimeUs = run_matmul(executor, m, &cpu);
+  m.validate();
   std::printf("  - matrix_size: %d\n", N);
-  std::printf("    duration: %zu us\n", totalTimeUs.count());
+  std::printf(
+    "    duration: %zu us\n", static_cast<size_t>(totalTimeUs.count())
+  );
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -99,16 +90,23 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
   }
   if (argc < 2) {
-    printf("Usage: matmul <matrix size (power of 2)>\n");
+    printf("Usage: matmul <matrix size> [threads] [config]\n");
     exit(0);
   }
-  int n = atoi(argv[1]);
+  // The config selects the base case kernel and the element type.
+  matmul_args args = matmul_parse_args(argc, argv);
   std::printf("threads: %zu\n", thread_count);
   executor.emplace(thread_count);
+  trace_observe(*executor);
 
-  run_matmul(*executor, n); // warmup
+  matmul_with_type(args.type, [&]<typename T>() {
+    {
+      matmul_matrices<T> warmup(args.n);
+      run_matmul(*executor, warmup);
+    }
 
-  std::printf("runs:\n");
+    std::printf("runs:\n");
 
-  run_one(*executor, n);
+    run_one<T>(*executor, args.n);
+  });
 }
@@ -0,0 +1,131 @@
+// Test performance of a producer-consumer pipeline with multiple CPU-bound
+// stages and a bounded number of items in flight.
+// The workload is defined in 2common/pipeline.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "pipeline.hpp"
+#include <taskflow/algorithm/pipeline.hpp>
+#include <taskflow/taskflow.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+using pipe_t = tf::Pipe<std::function<void(tf::Pipeflow&)>>;
+
+static void do_bench(tf::Executor& executor, pipeline_stats& stats) {
+  size_t num_lines = pipeline_token_count(thread_count);
+  // Each line holds the item currently being processed on it.
+  std::vector<pipeline_item> buffer(num_lines);
+
+  std::vector<pipe_t> pipes;
+  pipes.emplace_back(tf::PipeType::SERIAL, [&buffer](tf::Pipeflow& pf) {
+    if (pf.token() == pipeline_item_count) {
+      pf.stop();
+      return;
+    }
+    buffer[pf.line()] = pipeline_make_item(pf.token());
+  });
+  for (size_t stage = 1; stage < pipeline_stage_count - 1; ++stage) {
+    pipes.emplace_back(
+      tf::PipeType::PARALLEL,
+      [&buffer, stage](tf::Pipeflow& pf) {
+        auto& item = buffer[pf.line()];
+        item.value = pipeline_stage_work(item.value, stage);
+      }
+    );
+  }
+  pipes.emplace_back(
+    tf::PipeType::SERIAL,
+    [&buffer, &stats](tf::Pipeflow& pf) { stats.record(buffer[pf.line()]); }
+  );
+
+  tf::ScalablePipeline pl(num_lines, pipes.begin(), pipes.end());
+  tf::Taskflow taskflow;
+  taskflow.composed_of(pl);
+  executor.run(taskflow).wait();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("stages: %zu\n", pipeline_stage_count);
+  std::printf("tokens: %zu\n", pipeline_token_count(thread_count));
+  uint64_t expected = pipeline_expected_checksum();
+  tf::Executor executor(thread_count);
+
+  {
+    pipeline_stats stats;
+    do_bench(executor, stats); // warmup
+  }
+
+  pipeline_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    do_bench(executor, stats);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  if (stats.count != pipeline_item_count * iter_count ||
+      stats.checksum != expected * iter_count) {
+    std::printf(
+      "FAIL: Expected %zu items with checksum %" PRIu64
+      " but got %zu items with checksum %" PRIu64 "\n",
+      pipeline_item_count * iter_count, expected * iter_count, stats.count,
+      stats.checksum
+    );
+  }
+
+  size_t itemsPerSec = static_cast<size_t>(
+    static_cast<double>(stats.count) * 1000000.0 /
+    static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    items: %zu\n", stats.count);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    items/sec: %zu\n", itemsPerSec);
+  std::printf("    latency_p50: %zu us\n", stats.latency_us(50.0));
+  std::printf("    latency_p99: %zu us\n", stats.latency_us(99.0));
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -28,7 +28,10 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "trace_observer.hpp"
+#include "utilization.hpp"
 #include <taskflow/taskflow.hpp>
 
 #include <chrono>
@@ -42,8 +45,8 @@ static const size_t iter_count = 1;
 std::optional<tf::Executor> executor;
 
 template <size_t DepthMax> size_t skynet_one(size_t BaseNum, size_t Depth) {
-  if (Depth == DepthMax) {
-    return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    return skynet_serial(BaseNum, DepthMax - Depth);
   }
   size_t depthOffset = 1;
   for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
@@ -80,15 +83,18 @@ template <size_t DepthMax> void skynet(tf::Executor& executor) {
 
 template <size_t Depth = 6> void loop_skynet(tf::Executor& executor) {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     skynet<Depth>(executor);
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -98,6 +104,7 @@ int main(int argc, char* argv[]) {
   }
   std::printf("threads: %zu\n", thread_count);
   executor.emplace(thread_count);
+  trace_observe(*executor);
   skynet<8>(*executor);
   loop_skynet<8>(*executor);
 }
@@ -0,0 +1,19 @@
+#pragma once
+#include "trace.hpp"
+#include <taskflow/taskflow.hpp>
+
+// Records each task that a worker runs as a "task" span.
+class trace_observer : public tf::ObserverInterface {
+public:
+  void set_up(size_t) override {}
+  void on_entry(tf::WorkerView, tf::TaskView) override { trace_begin("task"); }
+  void on_exit(tf::WorkerView, tf::TaskView) override { trace_end("task"); }
+};
+
+// Attaches a trace_observer to Executor when built with SCHED_TRACE (see
+// trace.hpp).
+static inline void trace_observe([[maybe_unused]] tf::Executor& Executor) {
+#ifdef SCHED_TRACE
+  Executor.make_observer<trace_observer>();
+#endif
+}
@@ -0,0 +1,126 @@
+// Test the impact of blocking calls made from tasks.
+// A fraction of otherwise CPU-bound tasks make a blocking call. The call is
+// either made in place on the worker thread, or offloaded using the library's
+// mechanism for blocking work. Reports the task throughput.
+// The workload is defined in 2common/blocking.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "blocking.hpp"
+#include "memusage.hpp"
+#include <tbb/tbb.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t pct = 1;
+
+// When Pool is set, the task suspends itself and hands the blocking call to
+// the pool, which resumes the task afterward. This frees the worker thread
+// to run other tasks in the meantime.
+static void run_task(
+  size_t Index, blocking_thread_pool* Pool, std::vector<uint64_t>& Results
+) {
+  if (blocking_is_blocking(Index, pct)) {
+    if (Pool != nullptr) {
+      tbb::task::suspend([Pool](tbb::task::suspend_point tag) {
+        Pool->submit([tag]() {
+          blocking_call();
+          tbb::task::resume(tag);
+        });
+      });
+    } else {
+      blocking_call();
+    }
+  }
+  Results[Index] = blocking_cpu_work(Index);
+}
+
+static void
+run_all(blocking_thread_pool* Pool, std::vector<uint64_t>& Results) {
+  tbb::task_group tg;
+  for (size_t i = 0; i < blocking_task_count; ++i) {
+    tg.run([i, Pool, &Results]() { run_task(i, Pool, Results); });
+  }
+  tg.wait();
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    pct = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  bool offload = argc > 3 && strcmp(argv[3], "offload") == 0;
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("blocking_pct: %zu\n", pct);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  tbb::task_arena arena(thread_count);
+  blocking_thread_pool pool(offload ? blocking_offload_threads : 0);
+  uint64_t expected = blocking_expected_checksum();
+
+  std::vector<uint64_t> results(blocking_task_count);
+  arena.execute([&]() {
+    run_all(offload ? &pool : nullptr, results);
+  }); // warmup
+
+  auto startTime = std::chrono::high_resolution_clock::now();
+  arena.execute([&]() { run_all(offload ? &pool : nullptr, results); });
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  uint64_t sum = 0;
+  for (uint64_t r : results) {
+    sum += r;
+  }
+  if (sum != expected) {
+    std::printf(
+      "FAIL: expected checksum %" PRIu64 " but got %" PRIu64 "\n", expected, sum
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    tasks: %zu\n", blocking_task_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    tasks/sec: %zu\n",
+    static_cast<size_t>(blocking_task_count * 1000000 / totalTimeUs)
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
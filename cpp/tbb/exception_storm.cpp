@@ -0,0 +1,140 @@
+// Test the cost of exception propagation through a fork-join tree.
+// A skynet-shaped tree is run repeatedly, with a configurable fraction of
+// leaves throwing. Reports the time taken by rounds that complete normally
+// and by rounds that deliver an exception to the root.
+// The workload is defined in 2common/exception_storm.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "exception_storm.hpp"
+#include "memusage.hpp"
+#include <tbb/tbb.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t ppm = 0;
+
+// When a task throws, tbb cancels the rest of its task_group and rethrows
+// the exception from wait(). The parent task then rethrows it into its own
+// task_group, and so on up to the root.
+template <size_t DepthMax>
+size_t storm_one(size_t Round, size_t BaseNum, size_t Depth) {
+  if (Depth == DepthMax) {
+    return exception_storm_leaf(Round, BaseNum, ppm);
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
+    depthOffset *= 10;
+  }
+
+  std::array<size_t, 10> results;
+
+  tbb::task_group tg;
+  for (size_t i = 0; i < 9; ++i) {
+    tg.run([=, &results, idx = i]() {
+      results[idx] =
+        storm_one<DepthMax>(Round, BaseNum + depthOffset * idx, Depth + 1);
+    });
+  }
+  tg.run_and_wait([=, &results]() {
+    results[9] =
+      storm_one<DepthMax>(Round, BaseNum + depthOffset * 9, Depth + 1);
+  });
+
+  size_t count = 0;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    count += results[idx];
+  }
+  return count;
+}
+
+static void run_rounds(exception_storm_stats& Stats) {
+  for (size_t round = 0; round < exception_storm_rounds; ++round) {
+    auto start = std::chrono::steady_clock::now();
+    size_t result = 0;
+    bool threw = false;
+    try {
+      result = storm_one<exception_storm_depth>(round, 0, 0);
+    } catch (const exception_storm_error&) {
+      threw = true;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    Stats.record(round, threw, result, elapsed);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    ppm = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("throw_ppm: %zu\n", ppm);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  tbb::task_arena arena(thread_count);
+
+  {
+    exception_storm_stats stats(ppm);
+    arena.execute([&]() { run_rounds(stats); }); // warmup
+  }
+
+  exception_storm_stats stats(ppm);
+  auto startTime = std::chrono::high_resolution_clock::now();
+  arena.execute([&]() { run_rounds(stats); });
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  if (stats.wrong_results != 0) {
+    std::printf(
+      "FAIL: %zu of %zu rounds had the wrong outcome\n", stats.wrong_results,
+      exception_storm_rounds
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    rounds: %zu\n", exception_storm_rounds);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    rounds/sec: %zu\n",
+    static_cast<size_t>(exception_storm_rounds * 1000000 / totalTimeUs)
+  );
+  std::printf("    failed_rounds: %zu\n", stats.failed_rounds);
+  std::printf("    ok_round: %zu us\n", stats.ok_round_us());
+  std::printf("    failed_round: %zu us\n", stats.failed_round_us());
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
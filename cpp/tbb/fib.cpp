@@ -26,20 +26,25 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "trace_observer.hpp"
+#include "two_pools.hpp"
+#include "utilization.hpp"
 #include <tbb/tbb.h>
 
 #include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 
 size_t fibonacci(size_t n) {
-  if (n < 2)
-    return n;
+  if (n < fib_cutoff)
+    return fib_serial(n);
 
   size_t x, y;
 
@@ -50,6 +55,26 @@ size_t fibonacci(size_t n) {
   return x + y;
 }
 
+// Runs fib(n) on two arenas at once, each with half of the threads.
+static void run_two_pools(size_t n) {
+  tbb::task_arena arena0(static_cast<int>(two_pools_threads(thread_count, 0)));
+  tbb::task_arena arena1(static_cast<int>(two_pools_threads(thread_count, 1)));
+  tbb::task_arena* arenas[2] = {&arena0, &arena1};
+  size_t results[2];
+  for (size_t i = 0; i < 2; ++i) {
+    arenas[i]->execute([&] { results[i] = fibonacci(30); }); // warmup
+  }
+
+  auto result = two_pools_run([&](size_t Pool) {
+    arenas[Pool]->execute([&] { results[Pool] = fibonacci(n); });
+  });
+  std::printf("output: %zu %zu\n", results[0], results[1]);
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  result.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
 int main(int argc, char* argv[]) {
   if (argc > 2) {
     thread_count = static_cast<size_t>(atoi(argv[2]));
@@ -61,11 +86,21 @@ int main(int argc, char* argv[]) {
   size_t n = static_cast<size_t>(atoi(argv[1]));
 
   std::printf("threads: %zu\n", thread_count);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  if (argc > 3 && strcmp(argv[3], "2pool") == 0) {
+    run_two_pools(n);
+    return 0;
+  }
   tbb::task_arena arena(thread_count);
+  trace_observer observer(arena);
 
   size_t result;
   arena.execute([&] { result = fibonacci(n); }); // warmup
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -74,10 +109,12 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
@@ -10,7 +10,10 @@
 // License, v. 2.0. If a copy of the MPL was not distributed with this
 // file, You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "trace_observer.hpp"
+#include "utilization.hpp"
 #include <tbb/tbb.h>
 
 #include <array>
@@ -37,8 +40,8 @@ void check_answer(int result) {
 }
 
 template <size_t N> void nqueens(int xMax, std::array<char, N> buf, int& out) {
-  if (N == xMax) {
-    out = 1;
+  if (N - static_cast<size_t>(xMax) <= nqueens_cutoff) {
+    out = nqueens_serial(xMax, buf);
     return;
   }
 
@@ -94,7 +97,12 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[1]));
   }
   std::printf("threads: %zu\n", thread_count);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
   tbb::task_arena arena(thread_count);
+  trace_observer observer(arena);
 
   {
     std::array<char, nqueens_work> buf{};
@@ -103,6 +111,7 @@ int main(int argc, char* argv[]) {
     check_answer(result);
   }
 
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
 
   for (size_t i = 0; i < iter_count; ++i) {
@@ -114,10 +123,12 @@ int main(int argc, char* argv[]) {
   }
 
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("runs:\n");
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
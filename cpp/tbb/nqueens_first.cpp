@@ -0,0 +1,142 @@
+// Adapted from the benchmark provided at:
+// https://github.com/ConorWilliams/libfork/blob/ce40fa0f3178a43f5da8016788d6cfdadc85554f/bench/source/nqueens/libfork.cpp
+
+// Original Copyright Notice:
+// Copyright © Conor Williams <conorwilliams@outlook.com>
+
+// SPDX-License-Identifier: MPL-2.0
+
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at https://mozilla.org/MPL/2.0/.
+
+// Find-first variant: stops all outstanding work once the single matching
+// solution defined in 2common/nqueens_first.hpp is found.
+
+#include "memusage.hpp"
+#include "nqueens_first.hpp"
+#include <tbb/tbb.h>
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+// Cancelling the root task_group also cancels every nested task_group, since
+// they are bound to the context of the task that created them. Queued tasks
+// are then skipped, and running tasks stop at the next node.
+template <size_t N>
+void nqueens_first(
+  int xMax, std::array<char, N> buf, nqueens_first_state& State,
+  tbb::task_group& Root
+) {
+  if (tbb::is_current_task_group_canceling()) {
+    return;
+  }
+  if (N == xMax) {
+    uint64_t hash = nqueens_first_hash(buf);
+    if (nqueens_first_match(hash) && State.publish(hash)) {
+      Root.cancel();
+    }
+    return;
+  }
+
+  std::array<char, N> ys;
+  size_t taskCount = 0;
+  for (int y = 0; y < static_cast<int>(N); ++y) {
+    char q = static_cast<char>(y);
+    bool legal = true;
+    for (int x = 0; x < xMax; ++x) {
+      char p = buf[x];
+      if (q == p || q == p - (xMax - x) || q == p + (xMax - x)) {
+        legal = false;
+        break;
+      }
+    }
+    if (legal) {
+      ys[taskCount++] = static_cast<char>(y);
+    }
+  }
+
+  if (taskCount == 0) {
+    return;
+  }
+
+  tbb::task_group tg;
+  for (size_t i = 0; i + 1 < taskCount; ++i) {
+    buf[xMax] = ys[i];
+    tg.run([xMax, buf, &State, &Root]() {
+      nqueens_first(xMax + 1, buf, State, Root);
+    });
+  }
+  buf[xMax] = ys[taskCount - 1];
+  tg.run_and_wait([xMax, buf, &State, &Root]() {
+    nqueens_first(xMax + 1, buf, State, Root);
+  });
+}
+
+static void run_one(nqueens_first_state& State) {
+  std::array<char, nqueens_first_work> buf{};
+  tbb::task_group root;
+  root.run_and_wait([&]() { nqueens_first(0, buf, State, root); });
+}
+
+static void check_answer(const nqueens_first_state& State) {
+  if (!State.found() || State.answer != nqueens_first_answer) {
+    std::printf(
+      "FAIL: expected %" PRIu64 ", got %" PRIu64 "\n", nqueens_first_answer,
+      State.answer
+    );
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  tbb::task_arena arena(thread_count);
+
+  {
+    nqueens_first_state state;
+    arena.execute([&]() { run_one(state); }); // warmup
+    check_answer(state);
+  }
+
+  size_t answerUs = 0;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    nqueens_first_state state;
+    auto iterStart = std::chrono::steady_clock::now();
+    arena.execute([&]() { run_one(state); });
+    check_answer(state);
+    answerUs += static_cast<size_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+        state.found_at - iterStart
+      )
+        .count()
+    );
+    std::printf("output: %" PRIu64 "\n", state.answer);
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf("    time_to_answer: %zu us\n", answerUs);
+  std::printf("    drain: %zu us\n", totalTimeUs - answerUs);
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -0,0 +1,128 @@
+// Test performance of a producer-consumer pipeline with multiple CPU-bound
+// stages and a bounded number of items in flight.
+// The workload is defined in 2common/pipeline.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "pipeline.hpp"
+#include <tbb/tbb.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static const size_t iter_count = 1;
+
+static void do_bench(pipeline_stats& stats) {
+  size_t next = 0;
+  tbb::filter<void, pipeline_item> chain =
+    tbb::make_filter<void, pipeline_item>(
+      tbb::filter_mode::serial_in_order,
+      [&next](tbb::flow_control& fc) -> pipeline_item {
+        if (next == pipeline_item_count) {
+          fc.stop();
+          return {};
+        }
+        return pipeline_make_item(next++);
+      }
+    );
+  for (size_t stage = 1; stage < pipeline_stage_count - 1; ++stage) {
+    chain = chain & tbb::make_filter<pipeline_item, pipeline_item>(
+                      tbb::filter_mode::parallel,
+                      [stage](pipeline_item item) {
+                        item.value = pipeline_stage_work(item.value, stage);
+                        return item;
+                      }
+                    );
+  }
+  tbb::parallel_pipeline(
+    pipeline_token_count(thread_count),
+    chain & tbb::make_filter<pipeline_item, void>(
+              tbb::filter_mode::serial_out_of_order,
+              [&stats](pipeline_item item) { stats.record(item); }
+            )
+  );
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("stages: %zu\n", pipeline_stage_count);
+  std::printf("tokens: %zu\n", pipeline_token_count(thread_count));
+  uint64_t expected = pipeline_expected_checksum();
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  tbb::task_arena arena(thread_count);
+
+  {
+    pipeline_stats stats;
+    arena.execute([&] { do_bench(stats); }); // warmup
+  }
+
+  pipeline_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+
+  for (size_t i = 0; i < iter_count; ++i) {
+    arena.execute([&] { do_bench(stats); });
+  }
+
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs =
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count();
+
+  if (stats.count != pipeline_item_count * iter_count ||
+      stats.checksum != expected * iter_count) {
+    std::printf(
+      "FAIL: Expected %zu items with checksum %" PRIu64
+      " but got %zu items with checksum %" PRIu64 "\n",
+      pipeline_item_count * iter_count, expected * iter_count, stats.count,
+      stats.checksum
+    );
+  }
+
+  size_t itemsPerSec = static_cast<size_t>(
+    static_cast<double>(stats.count) * 1000000.0 /
+    static_cast<double>(totalTimeUs)
+  );
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: %zu\n", iter_count);
+  std::printf("    items: %zu\n", stats.count);
+  std::printf("    duration: %zu us\n", static_cast<size_t>(totalTimeUs));
+  std::printf("    items/sec: %zu\n", itemsPerSec);
+  std::printf("    latency_p50: %zu us\n", stats.latency_us(50.0));
+  std::printf("    latency_p99: %zu us\n", stats.latency_us(99.0));
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
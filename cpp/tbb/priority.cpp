@@ -0,0 +1,145 @@
+// Test priority scheduling under a saturating background load.
+// Repeated skynet trees run at low priority while an external thread injects
+// probe tasks at high priority. Reports probe latency percentiles and the
+// background throughput in trees/sec.
+// Pass "same" as the config argument to run the probes at the same priority
+// as the background load, for comparison.
+// The workload is defined in 2common/priority.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "priority.hpp"
+#include <tbb/tbb.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static bool use_priority = true;
+
+template <size_t DepthMax> size_t skynet_one(size_t BaseNum, size_t Depth) {
+  if (Depth == DepthMax) {
+    return BaseNum;
+  }
+  size_t depthOffset = 1;
+  for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
+    depthOffset *= 10;
+  }
+
+  std::array<size_t, 10> results;
+
+  tbb::task_group tg;
+  for (size_t i = 0; i < 9; ++i) {
+    tg.run([=, &results, idx = i]() {
+      results[idx] =
+        skynet_one<DepthMax>(BaseNum + depthOffset * idx, Depth + 1);
+    });
+  }
+  tg.run_and_wait([=, &results]() {
+    results[9] = skynet_one<DepthMax>(BaseNum + depthOffset * 9, Depth + 1);
+  });
+
+  size_t count = 0;
+  for (size_t idx = 0; idx < 10; ++idx) {
+    count += results[idx];
+  }
+  return count;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    thread_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2 && strcmp(argv[2], "same") == 0) {
+    use_priority = false;
+  }
+  std::printf("threads: %zu\n", thread_count);
+
+  // Both arenas share one pool of workers, so the probes only get a worker
+  // promptly if tbb moves one over from the background arena. Without
+  // priority, the probes are enqueued into the background arena instead.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  tbb::task_arena background(
+    static_cast<int>(thread_count), 1,
+    use_priority ? tbb::task_arena::priority::low
+                 : tbb::task_arena::priority::normal
+  );
+  tbb::task_arena probeArena(1, 0, tbb::task_arena::priority::high);
+  tbb::task_arena& target = use_priority ? probeArena : background;
+
+  priority_background bg;
+  std::thread bgThread([&]() {
+    background.execute([&]() {
+      while (!bg.stop.load(std::memory_order_relaxed)) {
+        bg.record(skynet_one<priority_background_depth>(0, 0));
+      }
+    });
+  });
+  // Let the background load ramp up before injecting probes.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  priority_probes probes;
+  size_t startTrees = bg.trees.load();
+  auto startTime = std::chrono::high_resolution_clock::now();
+  probes.run([&](size_t Index) {
+    target.enqueue([&probes, Index]() { probes.record(Index); });
+  });
+  auto endTime = std::chrono::high_resolution_clock::now();
+  size_t trees = bg.trees.load() - startTrees;
+  bg.stop.store(true);
+  bgThread.join();
+
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+  if (bg.wrong_results.load() != 0) {
+    std::printf("FAIL: background skynet returned the wrong result\n");
+  }
+  auto latency = probes.histogram();
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    probes: %zu\n", priority_probe_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    trees/sec: %zu\n",
+    static_cast<size_t>(trees * 1000000 / totalTimeUs)
+  );
+  std::printf("    probe_p50: %zu us\n", latency.percentile_us(50.0));
+  std::printf("    probe_p99: %zu us\n", latency.percentile_us(99.0));
+  std::printf("    probe_p999: %zu us\n", latency.percentile_us(99.9));
+  std::printf(
+    "    probe_max: %zu us\n", static_cast<size_t>(latency.max_ns / 1000)
+  );
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
@@ -28,20 +28,25 @@
 // ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 // OTHER DEALINGS IN THE SOFTWARE.
 
+#include "cutoff.hpp"
 #include "memusage.hpp"
+#include "trace_observer.hpp"
+#include "two_pools.hpp"
+#include "utilization.hpp"
 #include <tbb/tbb.h>
 
 #include <chrono>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 static size_t thread_count = std::thread::hardware_concurrency() / 2;
 static const size_t iter_count = 1;
 
 template <size_t DepthMax> size_t skynet_one(size_t BaseNum, size_t Depth) {
-  if (Depth == DepthMax) {
-    return BaseNum;
+  if (DepthMax - Depth <= skynet_cutoff) {
+    return skynet_serial(BaseNum, DepthMax - Depth);
   }
   size_t depthOffset = 1;
   for (size_t i = 0; i < DepthMax - Depth - 1; ++i) {
@@ -76,15 +81,36 @@ template <size_t DepthMax> void skynet() {
 
 template <size_t Depth = 6> void loop_skynet() {
   std::printf("runs:\n");
+  auto startCpu = utilization_now();
   auto startTime = std::chrono::high_resolution_clock::now();
   for (size_t j = 0; j < iter_count; ++j) {
     skynet<Depth>();
   }
   auto endTime = std::chrono::high_resolution_clock::now();
+  auto cpu = utilization_between(startCpu, utilization_now(), thread_count);
   auto totalTimeUs =
     std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
   std::printf("  - iteration_count: %" PRIu64 "\n", iter_count);
   std::printf("    duration: %" PRIu64 " us\n", totalTimeUs.count());
+  cpu.print_yaml();
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
+
+// Runs skynet on two arenas at once, each with half of the threads.
+template <size_t Depth = 6> void run_two_pools() {
+  tbb::task_arena arena0(static_cast<int>(two_pools_threads(thread_count, 0)));
+  tbb::task_arena arena1(static_cast<int>(two_pools_threads(thread_count, 1)));
+  tbb::task_arena* arenas[2] = {&arena0, &arena1};
+  for (size_t i = 0; i < 2; ++i) {
+    arenas[i]->execute(skynet<Depth>); // warmup
+  }
+
+  auto result = two_pools_run([&](size_t Pool) {
+    arenas[Pool]->execute(skynet<Depth>);
+  });
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  result.print_yaml();
   std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
 }
 
@@ -93,7 +119,16 @@ int main(int argc, char* argv[]) {
     thread_count = static_cast<size_t>(atoi(argv[1]));
   }
   std::printf("threads: %zu\n", thread_count);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  if (argc > 2 && strcmp(argv[2], "2pool") == 0) {
+    run_two_pools<8>();
+    return 0;
+  }
   tbb::task_arena arena(thread_count);
+  trace_observer observer(arena);
 
   arena.execute(skynet<8>); // warmup
   arena.execute(loop_skynet<8>);
@@ -0,0 +1,22 @@
+#pragma once
+#include "trace.hpp"
+#include <tbb/tbb.h>
+
+// Records the time that each thread spends in Arena as an "arena" span, when
+// built with SCHED_TRACE (see trace.hpp). Otherwise it doesn't observe.
+// Workers still in the arena when observation stops never get an exit
+// callback; trace_write closes their spans at exit.
+class trace_observer : public tbb::task_scheduler_observer {
+public:
+  explicit trace_observer(tbb::task_arena& Arena)
+      : tbb::task_scheduler_observer(Arena) {
+#ifdef SCHED_TRACE
+    observe(true);
+#endif
+  }
+
+  ~trace_observer() { observe(false); }
+
+  void on_scheduler_entry(bool) override { trace_begin("arena"); }
+  void on_scheduler_exit(bool) override { trace_end("arena"); }
+};
@@ -0,0 +1,122 @@
+// Test the cost of racing tasks and abandoning the losers.
+// Each race starts K tasks of random cost and takes the first result. Reports
+// the latency to the first result, and the share of work spent on losers
+// before they stopped.
+// The workload is defined in 2common/when_any.hpp.
+
+// Original author: tzcnt
+// Unlicense License
+// This is free and unencumbered software released into the public domain.
+
+// Anyone is free to copy, modify, publish, use, compile, sell, or
+// distribute this software, either in source code form or as a compiled
+// binary, for any purpose, commercial or non-commercial, and by any
+// means.
+
+// In jurisdictions that recognize copyright laws, the author or authors
+// of this software dedicate any and all copyright interest in the
+// software to the public domain. We make this dedication for the benefit
+// of the public at large and to the detriment of our heirs and
+// successors. We intend this dedication to be an overt act of
+// relinquishment in perpetuity of all present and future rights to this
+// software under copyright law.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+// EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+// MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+// IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+// OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+// OTHER DEALINGS IN THE SOFTWARE.
+
+#include "memusage.hpp"
+#include "when_any.hpp"
+#include <tbb/tbb.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+static size_t thread_count = std::thread::hardware_concurrency() / 2;
+static size_t task_count = 8;
+
+// tbb has no when_any, so the first task to complete all of its work claims
+// the win and sets the race's cancellation flag. The other tasks see the flag
+// and stop early.
+static void race_one(size_t Race, when_any_stats& Stats) {
+  when_any_race race(Race, task_count);
+  std::atomic<size_t> winner{SIZE_MAX};
+  tbb::task_group tg;
+  for (size_t i = 0; i < task_count; ++i) {
+    tg.run([&race, &winner, &Stats, i]() {
+      race.run(i);
+      if (race.units[i] != race.cost[i]) {
+        return;
+      }
+      size_t expected = SIZE_MAX;
+      if (winner.compare_exchange_strong(expected, i)) {
+        race.done.store(true, std::memory_order_relaxed);
+        Stats.record_first(race);
+      }
+    });
+  }
+  tg.wait();
+  Stats.record_done(race, winner.load());
+}
+
+static void run_races(when_any_stats& Stats) {
+  for (size_t i = 0; i < when_any_race_count; ++i) {
+    race_one(i, Stats);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 1) {
+    task_count = static_cast<size_t>(atoi(argv[1]));
+  }
+  if (argc > 2) {
+    thread_count = static_cast<size_t>(atoi(argv[2]));
+  }
+  std::printf("threads: %zu\n", thread_count);
+  std::printf("tasks: %zu\n", task_count);
+  // Without this, tbb caps its workers at the hardware concurrency.
+  tbb::global_control limit(
+    tbb::global_control::max_allowed_parallelism, thread_count
+  );
+  tbb::task_arena arena(thread_count);
+
+  {
+    when_any_stats stats;
+    arena.execute([&]() { run_races(stats); }); // warmup
+  }
+
+  when_any_stats stats;
+  auto startTime = std::chrono::high_resolution_clock::now();
+  arena.execute([&]() { run_races(stats); });
+  auto endTime = std::chrono::high_resolution_clock::now();
+  auto totalTimeUs = static_cast<size_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime)
+      .count()
+  );
+
+  if (stats.wrong_results != 0) {
+    std::printf(
+      "FAIL: %zu of %zu races had no valid winner\n", stats.wrong_results,
+      when_any_race_count
+    );
+  }
+  std::printf("runs:\n");
+  std::printf("  - iteration_count: 1\n");
+  std::printf("    races: %zu\n", when_any_race_count);
+  std::printf("    duration: %zu us\n", totalTimeUs);
+  std::printf(
+    "    races/sec: %zu\n",
+    static_cast<size_t>(when_any_race_count * 1000000 / totalTimeUs)
+  );
+  std::printf("    first_p50: %zu us\n", stats.first.percentile_us(50.0));
+  std::printf("    first_p99: %zu us\n", stats.first.percentile_us(99.0));
+  std::printf("    loser_work_pct: %zu\n", stats.loser_work_pct());
+  std::printf("    max_rss: %ld KiB\n", peak_memory_usage());
+}
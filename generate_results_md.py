@@ -12,6 +12,8 @@ RUNTIME_URLS = {
     "tbb": "https://www.intel.com/content/www/us/en/developer/tools/oneapi/onetbb.html",
     "cppcoro": "https://github.com/andreasbuhr/cppcoro",
     "taskflow": "https://github.com/taskflow/taskflow",
+    "openmp": "https://www.openmp.org/specifications/",
+    "refsched": "cpp/2common/refsched.hpp",
     "coros": "https://github.com/mtmucha/coros",
     "HPX": "https://github.com/STEllAR-GROUP/hpx",
     "concurrencpp": "https://github.com/David-Haim/concurrencpp",